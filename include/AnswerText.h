@@ -0,0 +1,27 @@
+#ifndef ANSWERTEXT_H
+#define ANSWERTEXT_H
+
+#include <QString>
+
+// How typed answers are compared and which keyboard they should come from.
+// Shared by every mode that checks typed translations.
+class AnswerText
+{
+public:
+    static QString removeHebrewDiacritics(const QString& text);
+    // Case- and niqqud-insensitive form used for every comparison; the same
+    // as removeHebrewDiacritics(text.toLower()), in one table-driven pass
+    // (SSE2 or AVX2 on x86). Text with letters outside ASCII and Hebrew goes
+    // through Unicode normalization instead. foldFinalForms also maps final
+    // letters to their ordinary forms (ך -> כ).
+    static QString normalize(const QString& text, bool foldFinalForms = false);
+
+    static bool isHebrew(QChar c);
+    // The hint to show when the last typed character is in the wrong
+    // script, or an empty string when it is in the expected one.
+    static QString keyboardWarning(const QString& typed, bool expectHebrew);
+
+    static void runBenchmark(int rounds);
+};
+
+#endif // ANSWERTEXT_H
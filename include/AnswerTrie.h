@@ -0,0 +1,34 @@
+#ifndef ANSWERTRIE_H
+#define ANSWERTRIE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+
+// Every normalized answer of a level, merged by common prefix, so the text
+// typed so far can be checked on each keystroke. A lookup walks one edge
+// per typed character and allocates nothing.
+class AnswerTrie
+{
+public:
+    static constexpr int kNoMatch = -1;
+
+    AnswerTrie();
+
+    void clear();
+    // answer must already be in AnswerText::normalize() form.
+    void insert(const QString& answer);
+    // The node typed leads to, or kNoMatch when no answer starts with it.
+    // typed is trimmed and normalized as it is walked.
+    int find(QStringView typed) const;
+    int size() const;
+
+private:
+    int advance(int node, QChar c) const;
+    int step(int node, QChar c) const;
+
+    QHash<quint64, int> edges;   // (node << 32 | character) -> child
+    int nodeCount;
+};
+
+#endif // ANSWERTRIE_H
@@ -0,0 +1,23 @@
+#ifndef APPSTYLE_H
+#define APPSTYLE_H
+
+#include <QApplication>
+#include <QString>
+#include <QWidget>
+
+// The application-wide stylesheet (resources/style.qss). Widgets select a
+// look with setRole() when they are built; runtime states such as a
+// warning or a wrong answer are a property flip plus a re-polish,
+// which is far cheaper than handing the widget a new stylesheet string.
+class AppStyle
+{
+public:
+    static void apply(QApplication& app);
+
+    static void setRole(QWidget* widget, const char* role);
+    static void setState(QWidget* widget, const char* property, const QString& value);
+
+    static void runBenchmark(int iterations);
+};
+
+#endif // APPSTYLE_H
@@ -0,0 +1,74 @@
+#ifndef ARCADEFIELD_H
+#define ARCADEFIELD_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QRandomGenerator>
+#include <QRegion>
+#include <QStaticText>
+#include <QTimer>
+
+// The falling-words playfield. Every word is drawn by one paintEvent from a
+// prepared QStaticText, and each frame repaints only the rectangles the
+// words left and entered, so dozens of words cost little more than one.
+class ArcadeField : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ArcadeField(QWidget* parent = nullptr);
+
+    // (prompt, answer) pairs the falling words are drawn from.
+    void setWords(const QList<QPair<QString, QString>>& pairs);
+    void start();
+    void stop();
+    void clear();
+    bool isRunning() const;
+    int level() const;
+
+    // Clears the lowest word whose answer matches the typed text.
+    bool tryAnswer(const QString& typed);
+
+    // Keeps the given number of words falling for a number of simulated
+    // 60 Hz frames and renders them into an image, so it needs no window.
+    // Reports wall and CPU time for dirty-rect and full repaints.
+    static void runBenchmark(int wordCount, int frames);
+
+signals:
+    void wordCleared(const QString& prompt, const QString& answer);
+    void wordMissed(const QString& prompt, const QString& answer);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    struct Word {
+        QString prompt;
+        QString answer;
+        QString normalizedAnswer;
+        QStaticText text;
+        QRectF rect;
+        qreal speed;
+    };
+
+    void tick();
+    // Moves every word on by the given time and returns the area to repaint.
+    QRegion advance(qreal seconds);
+    QRect spawn();
+    void paintField(QPainter& painter, const QRegion& region) const;
+    static QRect dirtyRect(const QRectF& rect);
+
+    QList<QPair<QString, QString>> pairs;
+    QList<Word> words;
+    QFont font;
+    QTimer frameTimer;
+    QElapsedTimer frameClock;
+    qint64 lastFrameNs = 0;
+    qreal untilSpawn = 0;
+    int cleared = 0;
+    QRandomGenerator random;
+};
+
+#endif // ARCADEFIELD_H
@@ -0,0 +1,57 @@
+#ifndef ARCADEWINDOW_H
+#define ARCADEWINDOW_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QList>
+#include <QPair>
+#include "ArcadeField.h"
+
+// Falling-words mode: Hebrew words drop down the field and the learner
+// types their English translation to clear them before they land.
+class ArcadeWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ArcadeWindow(QWidget* parent = nullptr);
+
+    void start(const QString& jsonFile);
+
+signals:
+    void finished();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void checkTyping();
+    void submitAnswer();
+    void wordCleared(const QString& prompt, const QString& answer);
+    void wordMissed(const QString& prompt, const QString& answer);
+    void restart();
+    void goBack();
+
+private:
+    static constexpr int kLives = 3;
+
+    void loadWords(const QString& jsonFile);
+    void updateStatus();
+
+    ArcadeField* field;
+    QLineEdit* answerEdit;
+    QLabel* statusLabel;
+    QLabel* feedbackLabel;
+    QPushButton* restartButton;
+    QPushButton* backButton;
+
+    QString jsonFile;
+    QList<QPair<QString, QString>> pairs;
+    int score = 0;
+    int lives = kLives;
+};
+
+#endif // ARCADEWINDOW_H
@@ -0,0 +1,62 @@
+#ifndef AUDIOPACK_H
+#define AUDIOPACK_H
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QLocale>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+// Speech synthesized ahead of time for a whole level and one voice, so a
+// kiosk need not run the speech engine for words it already knows. A pack
+// is a single file that is memory-mapped and played from in place: a
+// header, an index sorted by UTF-8 text for binary search, the texts, then
+// the PCM of every clip in one shared format. Texts missing from the packs
+// still go to the live engine.
+class AudioPack
+{
+public:
+    AudioPack();
+    ~AudioPack();
+
+    bool open(const QString& path, QString* error = nullptr);
+    QString voiceName() const;
+    QLocale locale() const;
+    QAudioFormat format() const;
+    int size() const;
+
+    // Points into the mapped file; empty when text is not in the pack.
+    QByteArray clip(const QString& text) const;
+
+    // Looks through the packs in resources/audio, opened on first use.
+    // voiceName is empty for the engine's default voice of locale.
+    static bool find(const QLocale& locale, const QString& voiceName, const QString& text,
+                     QAudioFormat& format, QByteArray& pcm);
+
+    static bool write(const QString& path, const QString& engine, const QString& voiceName,
+                      const QLocale& locale, const QAudioFormat& format,
+                      QList<QPair<QString, QByteArray>> clips, QString* error);
+
+    // Synthesizes the headwords and example sentences of each level with
+    // jobs engines in parallel and writes one pack per level.
+    static bool build(const QStringList& levels, const QLocale& locale, const QString& voiceName,
+                      int jobs, const QString& outputDir);
+
+private:
+    AudioPack(const AudioPack&) = delete;
+    AudioPack& operator=(const AudioPack&) = delete;
+
+    QFile file;
+    const uchar* data;
+    qint64 length;
+    quint32 entryCount;
+    const uchar* index;
+    QString voice;
+    QLocale packLocale;
+    QAudioFormat packFormat;
+};
+
+#endif // AUDIOPACK_H
@@ -0,0 +1,29 @@
+#ifndef BACKGROUNDCACHE_H
+#define BACKGROUNDCACHE_H
+
+#include <QLabel>
+#include <QPixmap>
+#include <QSize>
+
+// The faded "Learn English" artwork behind every window. Each variant
+// (opacity, size, device pixel ratio) is decoded once and then served from
+// QPixmapCache. Variants baked at build time (tools/AssetBaker.cpp) are used
+// as they are; anything else is scaled and faded from the source image.
+class BackgroundCache
+{
+public:
+    static QPixmap pixmap(qreal opacity, const QSize& size, qreal dpr = 1.0);
+
+    // Shows a flat placeholder right away when the variant is not cached
+    // yet and swaps in the artwork once a worker thread has composited it.
+    static void applyTo(QLabel* label, qreal opacity, const QSize& size);
+
+    static void preload(qreal opacity, const QSize& size, qreal dpr = 1.0);
+
+private:
+    static QString cacheKey(qreal opacity, const QSize& size, qreal dpr);
+    static QString bakedPath(qreal opacity, const QSize& size, qreal dpr);
+    static QImage compose(qreal opacity, const QSize& size, qreal dpr);
+};
+
+#endif // BACKGROUNDCACHE_H
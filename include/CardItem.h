@@ -0,0 +1,68 @@
+#ifndef CARDITEM_H
+#define CARDITEM_H
+
+#include <QGraphicsObject>
+#include <QPropertyAnimation>
+#include <QStaticText>
+
+// One memory-game card. The text layout is prepared once and the item is
+// rendered into a device-coordinate cache, so moving or fading it costs a
+// blit; only a state or hover change repaints it. Cards and their two
+// animations are recycled by MemoryBoard rather than deleted between rounds.
+class CardItem : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+    enum State { Normal, Selected, Mismatch };
+
+    CardItem(const QString& word, const QSizeF& size, QGraphicsItem* parent = nullptr);
+
+    // Puts a pooled card back into play with a new word.
+    void reset(const QString& word);
+    // Stops any animation and takes the card out of play.
+    void retire();
+
+    QString word() const;
+    State state() const;
+    void setState(State state);
+
+    // Where the board placed the card; animations always return here.
+    QPointF home() const;
+    void setHome(const QPointF& home);
+
+    // Moves out by offset and back home; loops < 0 repeats forever.
+    void bounce(const QPointF& offset, int duration, int loops = 1);
+    // Moves by offset while fading out, then hides.
+    void vanish(const QPointF& offset, int duration);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+signals:
+    void clicked();
+    // Emitted whenever one of the card's animations starts or stops.
+    void animationRunningChanged(bool running);
+
+protected:
+    void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
+    void hoverEnterEvent(QGraphicsSceneHoverEvent* event) override;
+    void hoverLeaveEvent(QGraphicsSceneHoverEvent* event) override;
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
+
+private:
+    void setWord(const QString& word);
+
+    QString text;
+    QStaticText label;
+    QSizeF cardSize;
+    QPointF homePos;
+    State cardState = Normal;
+    bool hovered = false;
+    bool pressed = false;
+    QPropertyAnimation* motion;
+    QPropertyAnimation* fade;
+};
+
+#endif // CARDITEM_H
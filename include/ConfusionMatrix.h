@@ -0,0 +1,54 @@
+#ifndef CONFUSIONMATRIX_H
+#define CONFUSIONMATRIX_H
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Sparse count of which headword learners gave (or paired) when another one
+// was expected, kept per user and for all users together. Words are always
+// English headwords so both translation directions and the memory game
+// share the same matrix.
+// A wrong answer only appends its pair to a journal; the full snapshot is
+// rewritten when the journal outgrows kJournalLimit and on exit. Journal
+// records carry the generation of the snapshot they extend, so records that
+// are already part of a newer snapshot are not counted twice.
+class ConfusionMatrix
+{
+public:
+    struct Pair
+    {
+        QString expected;
+        QString given;
+        int count = 0;
+    };
+
+    static const qint64 kJournalLimit = 64 * 1024;
+
+    static ConfusionMatrix& instance();
+
+    void record(const QString& user, const QString& expected, const QString& given);
+    void removeUser(const QString& user);
+
+    // An empty user name queries the matrix of all users.
+    QList<Pair> mostConfused(const QString& user, int count) const;
+    QStringList confusablesFor(const QString& user, const QString& word) const;
+    QStringList confusedWords(const QString& user) const;
+
+private:
+    typedef QHash<QString, QHash<QString, int>> Matrix;
+
+    ConfusionMatrix();
+    ~ConfusionMatrix();
+    void replayJournal();
+    void save();
+
+    QHash<QString, Matrix> matrices;
+    QString path;
+    QFile journal;
+    quint64 generation;
+};
+
+#endif // CONFUSIONMATRIX_H
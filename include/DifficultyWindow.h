@@ -1,31 +1,33 @@
 #ifndef DIFFICULTYWINDOW_H
 #define DIFFICULTYWINDOW_H
 
-#include <QMainWindow>
+#include <QWidget>
 #include <QPushButton>
 #include <QLabel>
-#include "GameWindow.h"
-#include "MemoryGame.h"
-#include "PracticeWindow.h"
 
 
-class DifficultyWindow : public QMainWindow
+class DifficultyWindow : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit DifficultyWindow(const QString& mode, QWidget* parent = nullptr);
+    explicit DifficultyWindow(QWidget* parent = nullptr);
     ~DifficultyWindow();
 
+    void setMode(const QString& mode);
+    QString mode() const;
+
+signals:
+    // Game and translation modes read the enhanced dictionary directly;
+    // memory and practice modes are handed the plain file name.
+    void levelChosen(const QString& mode, const QString& jsonFile);
+    void backRequested();
+
 private slots:
     void openLevel(int level);
-    void close();
 
 private:
     void setupUI();
-    void openMemoryGame(int level);
-    void openPracticeWindow(int level);
-    GameWindow* gameWindow;
     QString gameMode;
     QPushButton* btnLevel1;
     QPushButton* btnLevel2;
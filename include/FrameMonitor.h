@@ -0,0 +1,73 @@
+#ifndef FRAMEMONITOR_H
+#define FRAMEMONITOR_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <array>
+
+// Fixed-size histogram of durations in 0.25 ms buckets up to 200 ms, so
+// recording a frame never allocates.
+class FrameHistogram
+{
+public:
+    void add(qint64 ns);
+    void clear();
+    int count() const;
+    qint64 max() const;
+    qint64 mean() const;
+    // Upper bound of the bucket holding the given fraction (0..1) of samples.
+    qint64 percentile(double fraction) const;
+
+private:
+    static constexpr qint64 kBucketNs = 250000;
+    static constexpr int kBuckets = 800;
+
+    std::array<quint32, kBuckets + 1> buckets {};
+    int samples = 0;
+    qint64 total = 0;
+    qint64 largest = 0;
+};
+
+// Frame statistics for one view, collected only while it is animating. An
+// animation burst starts when the first animation starts and ends when the
+// last one stops; intervals are measured between paints of the same burst.
+class FrameMonitor
+{
+public:
+    explicit FrameMonitor(const QString& name);
+
+    // Instrumentation mode: --frame-stats or ELA_FRAME_STATS=1. Monitors
+    // start enabled when it is on.
+    static bool instrumentationEnabled();
+    static void setInstrumentationEnabled(bool enabled);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setRefreshRate(qreal hz);
+
+    void beginBurst();
+    void endBurst();
+    bool isRecording() const;
+
+    qint64 now() const;
+    void framePainted(qint64 startNs, qint64 costNs);
+
+    int frames() const;
+    int droppedFrames() const;
+    QString summary() const;
+    void clear();
+
+private:
+    QString name;
+    bool enabled;
+    bool animating = false;
+    qreal frameNs = 1e9 / 60;
+    QElapsedTimer clock;
+    qint64 lastFrameNs = -1;
+    int bursts = 0;
+    int dropped = 0;
+    FrameHistogram intervals;
+    FrameHistogram paintCosts;
+};
+
+#endif // FRAMEMONITOR_H
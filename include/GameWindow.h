@@ -1,36 +1,59 @@
 #ifndef GAMEWINDOW_H
 #define GAMEWINDOW_H
 
-#include <QMainWindow>
+#include <QWidget>
 #include <QJsonObject>
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QTextToSpeech>
+#include <QVoice>
 #include <QVBoxLayout>
 #include <QButtonGroup>
+#include <QCheckBox>
+#include <QSet>
+#include <QHash>
+#include "AnswerTrie.h"
+#include "SessionCheckpoint.h"
 
-class GameWindow : public QMainWindow
+class GameWindow : public QWidget
 {
     Q_OBJECT
 public:
-    GameWindow(const QString& mode, const QString& level, QWidget* parent = nullptr);
+    explicit GameWindow(const QString& mode, QWidget* parent = nullptr);
     ~GameWindow();
 
+    // The page is built once per mode; each session starts from here.
+    void start(const QString& level);
+    void restoreSession(const SessionState& state);
+
+signals:
+    void finished();
+
 private slots:
     void checkAnswer();
-    void close();
+    void goBack();
     void selectVoice(int voiceIndex);
     void playAudio();
     void checkKeyboardLanguage();
+    void updateLiveFeedback();
     void revealAnswer();
     void showExample();
 
 private:
     void loadDictionary(const QString& level);
+    void resetSession(const QString& level);
     void setupQuestion();
+    QString chooseKey(const QString& skip);
+    void prefetchNext();
+    void showQuestion(const QString& key);
+    void beginCheckpoint();
+    QString normalizeAnswer(const QString& text);
+    QString headword(const QString& key) const;
+    QString keyForHeadword(const QString& word);
     void setupUI();
     void updateVoiceButtons();
+    QLocale speechLocale() const;
+    void playAudioLater();
 
     QLabel* labelQuestion;
     QLabel* labelFeedback;
@@ -41,9 +64,16 @@ private:
     QPushButton* btnAudio;
     QPushButton* showAnswerButton;
     QPushButton* showExampleButton;
+    QCheckBox* liveCheckBox;
     QMap<QString, QPair<QString, QString>> examplesMap;
     QMap<QString, QString> dictionary;
+    QHash<QString, QString> answerToKey;
+    AnswerTrie answerTrie;
+    int correctAnswerNode;
+    bool answerRevealed;
+    QStringList pendingReview;
     QString currentKey;
+    QString upcomingKey;
     QString currentQuestion;
     QString correctAnswer;
     QString mode;
@@ -51,11 +81,13 @@ private:
 
     QString currentLevel;
     int currentWordCount;
-    QTextToSpeech* tts;
+    QSet<QString> answeredKeys;
+    QString userName;
+    SessionCheckpoint checkpoint;
     QList<QVoice> voices;
+    QVoice currentVoice;
     QBoxLayout* voiceLayout;
     QButtonGroup* voiceButtonGroup;
-	QString removeHebrewDiacritics(const QString& text);
 };
 
 #endif // GAMEWINDOW_H
@@ -0,0 +1,49 @@
+#ifndef HEADWORDINDEX_H
+#define HEADWORDINDEX_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Finds words by the start of any word of their English headword or Hebrew
+// translation, or of the translation typed in Latin letters ("shalom" for
+// שלום). Built once per word list into three sorted arrays of keys, so a
+// query is a binary search plus a walk over the matches.
+//
+// Latin spellings of Hebrew vary too much to match letter for letter, so
+// both sides are reduced to a consonant skeleton: vowels and the letters
+// that usually stand for them (א ה ו י ע) are dropped, and letters that
+// sound alike share one symbol (כ ק ח and k, ch, kh; ש ס and s, sh; ...).
+class HeadwordIndex
+{
+public:
+    HeadwordIndex();
+
+    // hebrew[i] translates english[i]; results are indices into them.
+    void build(const QStringList& english, const QStringList& hebrew);
+    // English matches come first, then transliterated Hebrew ones.
+    QList<int> find(const QString& query, int limit) const;
+    int size() const;
+
+    static QString skeleton(const QString& text);
+    static void runBenchmark(int queries);
+
+private:
+    struct Entry
+    {
+        QString key;
+        int word;
+    };
+
+    static void addWordStarts(QVector<Entry>& entries, const QString& text, int word);
+    static void sortEntries(QVector<Entry>& entries);
+    static void collect(const QVector<Entry>& entries, const QString& prefix, int limit, QList<int>& out);
+
+    QVector<Entry> englishKeys;
+    QVector<Entry> hebrewKeys;
+    QVector<Entry> latinKeys;
+    int words;
+};
+
+#endif // HEADWORDINDEX_H
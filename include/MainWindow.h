@@ -3,18 +3,26 @@
 
 #include <QMainWindow>
 #include <QPushButton>
+#include <QStackedWidget>
+#include <QHash>
 #include "GameWindow.h"
 #include "DifficultyWindow.h"
+#include "MemoryGame.h"
+#include "PracticeWindow.h"
+#include "ArcadeWindow.h"
+#include "StatsTableWidget.h"
 
 
 
 
+// The only top-level window. Every mode is a page of one stack that is
+// built the first time it is needed and then reused for every session.
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const QString& loggedInUser = QString(), QWidget* parent = nullptr);
     ~MainWindow();
 
 protected:
@@ -25,11 +33,30 @@ private slots:
     void openEnglishMode();
     void openPracticeWindow();
 	void openMemoryGame();
+    void openArcade();
     void openScoreTable();
     void exit();
-    void updateStatsTable(int score); 
+    void offerResume();
+    void startLevel(const QString& mode, const QString& jsonFile);
+    void showMenu();
+    void showDifficulty();
 private:
+    void openDifficulty(const QString& mode);
+    void resumeSession(const SessionState& state);
+    void showPage(QWidget* page);
+    GameWindow* gamePage(const QString& mode);
+    MemoryGame* memoryGamePage();
+    PracticeWindow* practicePage();
+    ArcadeWindow* arcadePage();
+
+    QStackedWidget* stack;
+    QWidget* menuPage;
     DifficultyWindow* difficultyWindow;
+    QHash<QString, GameWindow*> gameWindows;
+    MemoryGame* memoryGame;
+    PracticeWindow* practiceWindow;
+    ArcadeWindow* arcadeWindow;
+    StatsTableWidget* statsTable;
     QPushButton *btnExit;
   
 };
@@ -0,0 +1,85 @@
+#ifndef MEMORYBOARD_H
+#define MEMORYBOARD_H
+
+#include <QGraphicsView>
+#include <QGraphicsScene>
+#include <QList>
+#include "CardItem.h"
+#include "FrameMonitor.h"
+
+// The memory-game table: a scene of CardItems laid out on a grid of up to
+// 10x10 cells and scaled to fit the view. Animations only translate and
+// fade cards, which never invalidates their cached rendering.
+//
+// The board owns every card it ever creates, through its scene. Cards that
+// leave play are hidden and kept on a spare list for the next round, so a
+// game allocates at most one card per cell of the largest board it shows.
+class MemoryBoard : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kMaxColumns = 10;
+    static constexpr int kMaxRows = 10;
+
+    struct PoolStats {
+        int created = 0;   // cards ever allocated by this board
+        int reused = 0;    // times a spare card was put back into play
+        int inUse = 0;
+        int spare = 0;
+    };
+
+    explicit MemoryBoard(QWidget* parent = nullptr);
+    ~MemoryBoard() override;
+
+    void setColumns(int columns);
+    int columns() const;
+
+    // Cards are placed row by row in the order given. Pointers stay valid
+    // until the board is destroyed, but a card may carry another word after
+    // the next setCards() or clear().
+    void setCards(const QStringList& words);
+    void clear();
+    PoolStats poolStats() const;
+    QList<CardItem*> cards() const;
+    CardItem* card(const QString& word) const;
+
+    void playFlip(CardItem* card);
+    void playMatch(CardItem* first, CardItem* second);
+    void playMismatch(CardItem* first, CardItem* second);
+
+    // Keeps every card of a columns x rows board moving for the given time
+    // and reports frame intervals and paint cost.
+    static void runBenchmark(int columns, int rows, int milliseconds);
+    // Deals and plays the given number of rounds on random grid sizes and
+    // checks that neither cards nor their QObjects accumulate.
+    static bool runPoolCheck(int rounds);
+
+    // Frame statistics of the card animations; see FrameMonitor.
+    FrameMonitor& frameMonitor();
+    void dumpFrameStats() const;
+
+signals:
+    void cardClicked(CardItem* card);
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    void fitScene();
+    CardItem* takeCard(const QString& word);
+    int objectCount() const;
+    void trackAnimation(bool running);
+
+    QGraphicsScene* scene;
+    QList<CardItem*> items;
+    QList<CardItem*> spare;
+    PoolStats stats;
+    int columnCount = 2;
+
+    int runningAnimations = 0;
+    FrameMonitor monitor;
+};
+
+#endif // MEMORYBOARD_H
@@ -1,60 +1,69 @@
 #ifndef MEMORY_GAME_H
 #define MEMORY_GAME_H
 
-#include <QMainWindow>
+#include <QWidget>
 #include <QMap>
+#include <QHash>
 #include <QList>
-#include <QGridLayout>
+#include <QVBoxLayout>
 #include <QPushButton>
 #include <QLabel>
-#include <QPropertyAnimation>
-#include <QParallelAnimationGroup>
-#include <QSoundEffect>
+#include <QComboBox>
+#include "SessionCheckpoint.h"
+#include "MemoryBoard.h"
 
-class MemoryGame : public QMainWindow {
+class MemoryGame : public QWidget {
     Q_OBJECT
 public:
-    explicit MemoryGame(const QString& jsonFilePath, QWidget* parent = nullptr);
+    explicit MemoryGame(QWidget* parent = nullptr);
+
+    void start(const QString& jsonFilePath);
+    void restoreSession(const SessionState& state);
 
 signals:
     void memoryGameFinished(int score);
+    void finished();
 
 private slots:
-    void handleCardClick();
+    void handleCardClick(CardItem* card);
     void resetGame();
     void goBack();
-    void setButtonStyle(QPushButton* button, const QString& color);
-    void handleMismatch(QPushButton* firstButton, QPushButton* secondButton);
-    void handleMatch(QPushButton* firstButton, QPushButton* secondButton);
+    void changeGridSize(int index);
+    void handleMismatch(CardItem* firstCard, CardItem* secondCard);
+    void handleMatch(CardItem* firstCard, CardItem* secondCard);
     void saveScore(const QString& gameType, int score);
-    void playCardFlipAnimation(QPushButton* button);
-    void playMatchAnimation(QPushButton* button1, QPushButton* button2);
-    void playMismatchAnimation(QPushButton* button1, QPushButton* button2);
+    void playCardFlipAnimation(CardItem* card);
+    void playMatchAnimation(CardItem* card1, CardItem* card2);
+    void playMismatchAnimation(CardItem* card1, CardItem* card2);
 
 private:
     void loadWords(const QString& level);
     void initializeUI();
     void setupGameBoard();
+    void buildBoard(const QList<QString>& words, const QList<QString>& translations);
+    void removePair(CardItem* firstCard, CardItem* secondCard);
+    void clearBoard();
+    void beginCheckpoint();
     void filterUsedWords(QList<QString>& words);
     void saveUsedWords(const QList<QString>& words);
-    void setupSoundEffects();
 
     QMap<QString, QString> wordsMap;
-    QList<QString> englishWords;
+    QHash<QString, QString> hebrewToEnglish;
 
     QVBoxLayout* mainLayout;
-    QGridLayout* cardGrid;
-    QList<QPushButton*> englishButtons;
-    QList<QPushButton*> hebrewButtons;
+    MemoryBoard* board;
+    QComboBox* gridCombo;
     QString jsonFilePath;
-    QPushButton* firstSelectedButton = nullptr;
+    CardItem* firstSelectedCard = nullptr;
     QLabel* imageLabel;
     int matchedPairs = 0;
-
-    // Sound effects
-    QSoundEffect* matchSound;
-    QSoundEffect* mismatchSound;
-    QSoundEffect* flipSound;
+    // Cards are recycled between rounds, so delayed callbacks compare this
+    // rather than trusting that a card still shows the word they expect.
+    int boardRound = 0;
+    QList<QString> boardWords;
+    QList<QString> boardTranslations;
+    QList<QString> matchedWords;
+    SessionCheckpoint checkpoint;
 };
 
 #endif // MEMORY_GAME_H
\ No newline at end of file
@@ -1,39 +1,69 @@
 #ifndef PRACTICEWINDOW_H
 #define PRACTICEWINDOW_H
 
-#include <QMainWindow>
+#include <QWidget>
 #include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
 #include <QPushButton>
 #include <QMap>
-#include <QTextToSpeech>
+#include <QBuffer>
+#include "HeadwordIndex.h"
+#include "SessionCheckpoint.h"
 
-class PracticeWindow : public QMainWindow {
+class QAudioSource;
+
+class PracticeWindow : public QWidget {
     Q_OBJECT
 
 public:
-    explicit PracticeWindow(const QString& jsonFile, QWidget* parent = nullptr);
+    explicit PracticeWindow(QWidget* parent = nullptr);
 
     ~PracticeWindow();
 
+    void start(const QString& jsonFile);
+    void restoreSession(const SessionState& state);
+
+signals:
+    void finished();
+
 private slots:
     void nextWord();
     void prevWord();
     void playSound();
+    void playExample();
+    void recordAnswer();
+    void updateSearch();
+    void openSearchResult(QListWidgetItem* item);
     void goBack();
 private:
     void loadWords(QString& jsonFile);
     void updateDisplay();
+    void beginCheckpoint();
+    QString positionRegister() const;
     void loadWords(const QString& jsonFile);
+    void openLevel(const QString& jsonFile);
+    void playSoundLater();
+    void scoreRecording(const QString& word);
+    void jumpTo(int index);
 
 
 
     QLabel* englishWordLabel;
     QLabel* hebrewTranslationLabel;
     QPushButton* playSoundButton;
+    QPushButton* playExampleButton;
     QPushButton* nextButton;
     QPushButton* prevButton;
     QPushButton* closeButton;
     QPushButton* backButton;
+    QPushButton* recordButton;
+    QLabel* scoreLabel;
+    QLineEdit* searchEdit;
+    QListWidget* searchResults;
+    HeadwordIndex headwordIndex;
+    QAudioSource* microphone;
+    QBuffer recording;
 
 
     QMap<QString, QString> wordsMap;
@@ -42,8 +72,8 @@ private:
     QLabel* exampleEnLabel;
     QLabel* exampleHeLabel;
     int currentIndex;
-    QTextToSpeech* textToSpeech;
-    QList<QVoice> voices;
+    QString jsonFile;
+    SessionCheckpoint checkpoint;
 
 };
 
@@ -0,0 +1,30 @@
+#ifndef PROGRESSARCHIVE_H
+#define PROGRESSARCHIVE_H
+
+#include <QSettings>
+#include <QString>
+#include "ProgressLog.h"
+
+// Moves learner progress (scores, used words and the answer history) between
+// machines. Passwords never leave the settings store. Both directions stream
+// the answer history in batches, so memory use does not grow with the class.
+// Scores travel as ProgressSync's per-device counters and are merged the same
+// way, so an import followed by a sync never counts points twice.
+class ProgressArchive
+{
+public:
+    ProgressArchive(QSettings& settings, const ProgressLog& log);
+
+    bool exportTo(const QString& filePath, QString* error = nullptr);
+    bool importFrom(const QString& filePath, QString* error = nullptr);
+
+    static void runBenchmark(int eventCount);
+
+private:
+    QStringList users() const;
+
+    QSettings& settings;
+    const ProgressLog& log;
+};
+
+#endif // PROGRESSARCHIVE_H
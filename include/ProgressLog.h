@@ -0,0 +1,88 @@
+#ifndef PROGRESSLOG_H
+#define PROGRESSLOG_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryFile>
+#include <functional>
+
+struct AnswerEvent
+{
+    qint64 timestamp = 0;   // ms since epoch
+    QString game;           // "Hebrew", "English" or "MemoryGame"
+    int level = 0;
+    QString word;
+    bool correct = false;
+};
+
+QDataStream& operator<<(QDataStream& out, const AnswerEvent& event);
+QDataStream& operator>>(QDataStream& in, AnswerEvent& event);
+// Orders by timestamp, then by every other field, so equal events are adjacent.
+bool operator<(const AnswerEvent& a, const AnswerEvent& b);
+bool operator==(const AnswerEvent& a, const AnswerEvent& b);
+
+// History of answers, one file per user, in timestamp order: answers are
+// appended as they happen and imported ones are merged in. Readers get the
+// events in fixed-size batches so a long history never has to fit in memory.
+class ProgressLog
+{
+public:
+    // Merges events into a user's log, which is rewritten in order with
+    // exact duplicates dropped. Incoming events are sorted in runs of
+    // kBatchSize spilled to a temporary file; finish() merges the runs with
+    // the old log in one pass, so memory stays bounded whatever the size of
+    // either. Nothing changes unless finish() succeeds.
+    class Merge
+    {
+    public:
+        Merge(const ProgressLog& log, const QString& userName);
+
+        void add(const AnswerEvent& event);
+        bool finish();
+
+    private:
+        Merge(const Merge&) = delete;
+        Merge& operator=(const Merge&) = delete;
+        bool spill();
+
+        const ProgressLog& log;
+        QString userName;
+        QList<AnswerEvent> pending;
+        QTemporaryFile runs;
+        QList<QPair<qint64, qint64>> runBounds;   // offset and event count
+        bool failed;
+    };
+
+    static const int kBatchSize = 4096;
+
+    explicit ProgressLog(const QString& directory = defaultDirectory());
+
+    static QString defaultDirectory();
+    static int levelFromFile(const QString& dictionaryFile);
+    static void record(const QString& game, const QString& dictionaryFile, const QString& word, bool correct);
+
+    QStringList users() const;
+    bool append(const QString& userName, const QList<AnswerEvent>& events) const;
+    void remove(const QString& userName) const;
+    // A user without a log has no events, which is not an error. Returns
+    // false if the log exists but cannot be opened, has an unknown format or
+    // ends in a damaged record; the events before the damage are delivered.
+    // from is a position returned by size(), to read only what came after it.
+    bool read(const QString& userName,
+              const std::function<bool(const QList<AnswerEvent>&)>& onBatch,
+              int batchSize = kBatchSize, qint64 from = 0) const;
+    qint64 size(const QString& userName) const;
+    // Digest of the bytes just before position. It stays the same while the
+    // log is only appended to and changes when a merge rewrites it.
+    QByteArray digest(const QString& userName, qint64 position) const;
+
+private:
+    QString pathFor(const QString& userName) const;
+
+    QString directory;
+};
+
+#endif // PROGRESSLOG_H
@@ -0,0 +1,89 @@
+#ifndef PROGRESSSTATS_H
+#define PROGRESSSTATS_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <functional>
+#include <set>
+#include "ProgressLog.h"
+
+// Aggregates over the answer history that are kept up to date as answers
+// come in, so the score table never has to scan the history:
+//   - a ranking of users by correct answers per (game, level), level 0 being
+//     all levels together, updated in O(log n),
+//   - current and best streak of consecutive days with answers,
+//   - accuracy over the last kAccuracyWindow answers of each user.
+// Answers only update memory; the snapshot is written kSaveDelayMs after the
+// first change and on exit. It records how far into each user's log it goes,
+// so on start only the answers logged after it are replayed. Only a log that
+// was rewritten since (see ProgressLog::digest) or a missing snapshot costs a
+// full rebuild, which relies on each log being in timestamp order.
+class ProgressStats
+{
+public:
+    static const int kTopCount = 10;
+    static const int kAccuracyWindow = 50;
+    static const int kSaveDelayMs = 5000;
+
+    struct Entry
+    {
+        QString user;
+        int score = 0;
+    };
+
+    static ProgressStats& instance();
+
+    void record(const QString& user, const AnswerEvent& event);
+    // Raises the all-levels board of a game to at least the given score;
+    // used for totals kept in QSettings from before the answer log existed.
+    void raiseScore(const QString& user, const QString& game, int score);
+    void removeUser(const QString& user);
+    void rebuild();
+    void flush();
+
+    QList<Entry> top(const QString& game, int level, int count = kTopCount) const;
+    int currentStreak(const QString& user) const;
+    int bestStreak(const QString& user) const;
+    int recentAnswers(const QString& user) const;
+    int recentCorrect(const QString& user) const;
+
+private:
+    struct Board
+    {
+        QHash<QString, int> scores;
+        std::set<std::pair<int, QString>, std::greater<std::pair<int, QString>>> ranking;
+    };
+
+    struct UserStats
+    {
+        qint64 lastDay = 0;
+        int currentStreak = 0;
+        int bestStreak = 0;
+        quint64 recentBits = 0;
+        int recentPos = 0;
+        int recentCount = 0;
+        int recentCorrect = 0;
+    };
+
+    ProgressStats();
+    ~ProgressStats();
+    void apply(const QString& user, const AnswerEvent& event);
+    void addToBoard(const QString& game, int level, const QString& user);
+    int boardScore(const QString& game, int level, const QString& user) const;
+    void setBoardScore(const QString& game, int level, const QString& user, int score);
+    void markDirty();
+    bool load();
+    bool catchUp();
+    void save();
+
+    QHash<QPair<QString, int>, Board> boards;
+    QHash<QString, UserStats> users;
+    // Log size and digest per user when the snapshot was taken.
+    QHash<QString, QPair<qint64, QByteArray>> logPositions;
+    QString path;
+    bool dirty;
+};
+
+#endif // PROGRESSSTATS_H
@@ -0,0 +1,56 @@
+#ifndef PROGRESSSYNC_H
+#define PROGRESSSYNC_H
+
+#include <QSettings>
+#include <QString>
+#include <QVariant>
+#include "ProgressLog.h"
+
+// Offline sync between devices of the same learner. Every device exports a
+// state file; merging a file is commutative, idempotent and associative:
+//   - scores are G-counters (one monotonic count per device, merged by max);
+//     this device's count is kept in <user>/sync/<device>/<game> next to the
+//     remote ones and only ever grows, through addScore() or by taking a
+//     larger copy of it back from another device,
+//   - used words are merged by set union,
+//   - registers (e.g. practice position) keep the value with the newest
+//     timestamp, ties broken by device id,
+//   - answer events are merged by set union.
+class ProgressSync
+{
+public:
+    struct Counter
+    {
+        QString device;
+        QString game;
+        qint64 value = 0;
+    };
+
+    ProgressSync(QSettings& settings, const ProgressLog& log);
+
+    static QString deviceId(QSettings& settings);
+    // Adds points scored on this device to the total and to its own counter.
+    static void addScore(QSettings& settings, const QString& user, const QString& game, qint64 points);
+    // Every device counter known for a user, this device's included.
+    static QList<Counter> counters(QSettings& settings, const QString& user);
+    // Takes the larger of the known and the given count and adds the
+    // difference to the total; applying the same counter twice is harmless.
+    static void mergeCounter(QSettings& settings, const QString& user, const Counter& counter);
+    static void setRegister(const QString& name, const QVariant& value);
+    static QVariant registerValue(const QString& name, const QVariant& defaultValue = QVariant());
+
+    bool exportState(const QString& filePath, QString* error = nullptr);
+    bool mergeState(const QString& filePath, QString* error = nullptr);
+
+    static void runBenchmark(int eventCount);
+
+private:
+    QStringList users() const;
+    static QStringList games(QSettings& settings, const QString& user);
+
+    QSettings& settings;
+    const ProgressLog& log;
+    QString device;
+};
+
+#endif // PROGRESSSYNC_H
@@ -0,0 +1,40 @@
+#ifndef PRONUNCIATIONSCORER_H
+#define PRONUNCIATIONSCORER_H
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Scores how close a recorded word is to a reference recording of the same
+// word, entirely offline. Both are turned into MFCCs (25 ms frames every
+// 10 ms at 16 kHz, silence trimmed, each coefficient normalized to zero mean
+// and unit variance) and aligned with dynamic time warping; the mean frame
+// distance along the alignment is mapped to a 0-100 score.
+class PronunciationScorer
+{
+public:
+    static constexpr int kSampleRate = 16000;
+    static constexpr int kCoefficients = 13;
+
+    struct Features
+    {
+        int frames = 0;
+        // Coefficient-major: all frames of c0, then all frames of c1, ...
+        QVector<float> values;
+    };
+
+    // Mono float samples at kSampleRate.
+    static QVector<float> toMono(const QAudioFormat& format, const QByteArray& pcm);
+    static QVector<float> loadWav(const QString& path);
+
+    static Features extract(const QVector<float>& samples);
+    // Mean frame distance along the best alignment; 0 for identical input.
+    static float distance(const Features& learner, const Features& reference);
+    static int score(float distance);
+    static int score(const QVector<float>& learner, const QVector<float>& reference);
+
+    static void runBenchmark(int runs);
+};
+
+#endif // PRONUNCIATIONSCORER_H
@@ -0,0 +1,58 @@
+#ifndef SESSIONCHECKPOINT_H
+#define SESSIONCHECKPOINT_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+struct SessionState
+{
+    QString gameMode;   // "Hebrew", "English", "Memory" or "Practice"
+    QString level;      // dictionary file the window was opened with
+    int score = 0;
+    int currentWordCount = 0;
+    int position = 0;
+    QString currentKey;
+    QStringList answered;
+    QStringList board;
+    QStringList boardTranslations;
+};
+
+// Keeps the running session of one user on disk so it survives a crash or
+// an unexpected exit. begin() writes a full snapshot through QSaveFile (atomic
+// rename); every answer after that is appended to a small journal that is
+// replayed on top of the snapshot by load(). Each snapshot gets a random
+// generation that every journal record repeats, so records left over from an
+// older snapshot are ignored.
+class SessionCheckpoint
+{
+public:
+    explicit SessionCheckpoint(const QString& userName);
+    ~SessionCheckpoint();
+
+    void begin(const SessionState& state);
+    void recordAnswer(const QString& word, int score, int wordCount);
+    void recordCurrent(const QString& key);
+    void recordPosition(int position);
+    void clear();
+
+    static QString currentUserName();
+    static bool load(const QString& userName, SessionState& state);
+
+private:
+    enum RecordType : quint8 {
+        AnswerRecord = 1,
+        CurrentRecord = 2,
+        PositionRecord = 3
+    };
+
+    void append(RecordType type, const QString& word, int score, int count);
+    static QString basePath(const QString& userName);
+
+    QString snapshotPath;
+    QString journalPath;
+    QFile journal;
+    quint64 generation;
+};
+
+#endif // SESSIONCHECKPOINT_H
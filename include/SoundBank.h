@@ -0,0 +1,48 @@
+#ifndef SOUNDBANK_H
+#define SOUNDBANK_H
+
+#include <QAudioFormat>
+#include <QList>
+#include <QObject>
+#include <QVector>
+
+class QAudioSink;
+class QTimer;
+class SoundMixer;
+
+// Feedback sounds for every game. The WAVs are decoded once into the
+// output format and all plays are mixed into a single audio sink, so
+// overlapping plays layer instead of restarting each other.
+class SoundBank : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Sound
+    {
+        Flip,
+        Match,
+        Mismatch,
+        SoundCount
+    };
+
+    static SoundBank& instance();
+
+    // Decodes the sounds and opens the output; play() does it on first use.
+    void preload();
+    void play(Sound sound, float volume = 0.5f);
+
+    // Interleaved float samples in the rate and channel count of format.
+    static QVector<float> decodeWav(const QString& path, const QAudioFormat& format);
+
+private:
+    explicit SoundBank(QObject* parent);
+
+    QAudioFormat format;
+    QList<QVector<float>> sounds;
+    QAudioSink* sink;
+    SoundMixer* mixer;
+    QTimer* idleTimer;
+};
+
+#endif // SOUNDBANK_H
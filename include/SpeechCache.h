@@ -0,0 +1,117 @@
+#ifndef SPEECHCACHE_H
+#define SPEECHCACHE_H
+
+#include <QAudioFormat>
+#include <QBuffer>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLocale>
+#include <QObject>
+#include <QString>
+#include <QTextToSpeech>
+#include <QVoice>
+
+class QAudioSink;
+
+// Speaks text through a QTextToSpeech engine but synthesizes each
+// (engine, voice, locale, rate, pitch, text) only once. The PCM is shared by
+// every player through an in-memory LRU with files in the cache directory
+// behind it, so replaying a word only hands a buffer to the audio sink.
+// Engines that cannot synthesize to PCM are asked to say() the text instead.
+//
+// Requests carry their own locale and voice. The engine is only switched
+// when it has to synthesize or say something, so cache hits never pay for
+// a voice change.
+class SpeechCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Clip
+    {
+        QAudioFormat format;
+        QByteArray pcm;
+    };
+
+    struct Request
+    {
+        QString text;
+        QLocale locale;
+        QVoice voice;   // invalid: the engine's default voice for locale
+    };
+
+    struct Stats
+    {
+        int memoryHits = 0;
+        int diskHits = 0;
+        int packHits = 0;       // played from a pre-built AudioPack
+        int misses = 0;
+        int spoken = 0;         // engine without PCM synthesis, went through say()
+        int superseded = 0;     // requests dropped because a newer one came first
+        int timedReplays = 0;   // hits whose playback start was measured
+        qint64 replayNsTotal = 0;
+        qint64 replayNsMax = 0;
+        qint64 lastReplayNs = 0;
+        int prefetched = 0;     // clips synthesized ahead of being asked for
+        int prefetchHits = 0;   // of those, spoken later straight from the cache
+        int firstAudioCount = 0;
+        qint64 firstAudioNsTotal = 0;   // speak() to sound, hit or miss
+        qint64 firstAudioNsMax = 0;
+        qint64 lastFirstAudioNs = 0;
+    };
+
+    explicit SpeechCache(QTextToSpeech* engine, QObject* parent = nullptr);
+
+    // Replaces whatever is playing or waiting to be played.
+    void speak(const Request& request);
+    // Synthesizes into the cache without playing, after anything already
+    // being synthesized. Only the latest prefetch is kept.
+    void prefetch(const Request& request);
+    void stop();
+    bool isSpeaking() const;
+    bool isBusy() const;
+    // The clip request would play from a pack or the cache, without
+    // synthesizing anything.
+    bool findClip(const Request& request, Clip& clip) const;
+
+    static Stats stats();
+    static QString summary();
+    static void clearMemory();
+    static void runBenchmark(int replays);
+
+signals:
+    // The last speak() has been heard to the end, or could not be played.
+    void finished();
+
+private:
+    bool canSynthesize() const;
+    QString keyFor(const Request& request) const;
+    bool fromPack(const Request& request, Clip& clip) const;
+    void applyVoice(const Request& request);
+    void play(const Clip& clip, bool timed);
+    void startSynthesis(const Request& request, bool playWhenDone);
+    void engineStateChanged(QTextToSpeech::State state);
+
+    static bool lookup(const QString& key, Clip& clip, bool& fromDisk);
+    static void store(const QString& key, const Clip& clip);
+
+    QTextToSpeech* engine;
+    QHash<QString, QVoice> defaultVoices;   // by locale name
+    QAudioSink* sink;
+    QBuffer playback;
+    QElapsedTimer replayClock;
+    bool timingReplay;
+    bool timingFirstAudio;
+    bool saying;
+
+    bool synthesizing;
+    bool playWhenSynthesized;
+    Request synthesisRequest;
+    QString synthesisKey;
+    Clip synthesized;
+    Request queued;
+    Request prefetchRequest;
+};
+
+#endif // SPEECHCACHE_H
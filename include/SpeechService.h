@@ -0,0 +1,68 @@
+#ifndef SPEECHSERVICE_H
+#define SPEECHSERVICE_H
+
+#include <QHash>
+#include <QList>
+#include <QLocale>
+#include <QObject>
+#include <QString>
+#include <QTextToSpeech>
+#include <QVoice>
+#include "SpeechCache.h"
+
+// The one speech engine of the application. Pages never load the engine
+// themselves: start() creates it on a later turn of the event loop, voices
+// are listed once per language, and ready() tells pages when they can build
+// their voice choices. Text spoken before then is kept and spoken once the
+// engine is up.
+//
+// Requests are scheduled by priority. A new word cuts off whatever is
+// playing and drops everything still waiting, an example sentence waits
+// for the word before it, and a prefetch only fills the cache when the
+// engine has nothing better to do.
+class SpeechService : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority
+    {
+        Word,
+        Example,
+        Prefetch
+    };
+
+    static SpeechService& instance();
+
+    void start();
+    bool isReady() const;
+
+    QList<QVoice> voices(const QLocale& locale);
+
+    // An invalid voice uses the engine's default voice for locale.
+    void speak(const QString& text, const QLocale& locale, const QVoice& voice = QVoice(),
+               Priority priority = Word);
+    // Gets text ready in the speech cache so a later speak() starts at once.
+    // Does nothing until the engine is up.
+    void prefetch(const QString& text, const QLocale& locale, const QVoice& voice = QVoice());
+    void stop();
+    // The synthesized audio of text if it has been spoken or prefetched.
+    bool findClip(const QString& text, const QLocale& locale, SpeechCache::Clip& clip,
+                  const QVoice& voice = QVoice()) const;
+
+signals:
+    void ready();
+
+private:
+    explicit SpeechService(QObject* parent);
+    void createEngine();
+    void speakNext();
+
+    QTextToSpeech* engine;
+    SpeechCache* cache;
+    bool starting;
+    QHash<int, QList<QVoice>> catalogue;   // by QLocale::Language
+    QList<SpeechCache::Request> waiting;   // examples queued behind a word
+};
+
+#endif // SPEECHSERVICE_H
@@ -6,6 +6,8 @@
 #include <QTableWidget>
 #include <QVBoxLayout>
 #include <QMap>
+#include <QComboBox>
+#include <QLabel>
 
 class StatsTableWidget : public QWidget {
     Q_OBJECT
@@ -14,13 +16,23 @@ public:
     explicit StatsTableWidget(QWidget* parent = nullptr);
 
     void addScore(const QString& gameType, int score);
+    void refreshTable();
+
+private slots:
+    void exportProgress();
+    void importProgress();
+    void exportDeviceState();
+    void mergeDeviceState();
+    void showConfusions();
 
 private:
     QTableWidget* table;
+    QComboBox* gameCombo;
+    QComboBox* levelCombo;
+    QLabel* streakLabel;
     QMap<QString, int> scores;
     void loadScores();
     void saveScores();
-    void refreshTable();
     void deleteUserScores(QTableWidget* table);
 };
 
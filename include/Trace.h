@@ -0,0 +1,51 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QtGlobal>
+
+// Scoped spans written as Chrome trace-event JSON, for loading into Perfetto
+// or chrome://tracing. Configure with -DELA_TRACING=ON to build the spans
+// in; otherwise every ELA_TRACE_* macro expands to nothing. A tracing build
+// still records nothing unless ELA_TRACE=<file> is set or --trace <file> is
+// passed.
+class Trace
+{
+public:
+    // Runs before QApplication exists so its construction can be timed too.
+    // The file is written when the process exits.
+    static void startFromArguments(int argc, char* argv[]);
+    static bool isEnabled();
+
+    class Span
+    {
+    public:
+        // name must outlive the process, i.e. be a string literal.
+        explicit Span(const char* name);
+        ~Span();
+        void end();
+
+    private:
+        const char* name;
+        qint64 startNs;
+    };
+
+private:
+    static void record(const char* name, qint64 startNs, qint64 endNs);
+    static void write();
+};
+
+#ifdef ELA_TRACING
+#define ELA_TRACE_CONCAT_(a, b) a##b
+#define ELA_TRACE_CONCAT(a, b) ELA_TRACE_CONCAT_(a, b)
+#define ELA_TRACE_START(argc, argv) Trace::startFromArguments(argc, argv)
+#define ELA_TRACE_SCOPE(name) Trace::Span ELA_TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define ELA_TRACE_BEGIN(span, name) Trace::Span span(name)
+#define ELA_TRACE_END(span) span.end()
+#else
+#define ELA_TRACE_START(argc, argv) do {} while (false)
+#define ELA_TRACE_SCOPE(name) do {} while (false)
+#define ELA_TRACE_BEGIN(span, name) do {} while (false)
+#define ELA_TRACE_END(span) do {} while (false)
+#endif
+
+#endif // TRACE_H
@@ -1,23 +1,264 @@
 #include "MainWindow.h"
 #include "UserNameDialog.h"
+#include "ProgressArchive.h"
+#include "ProgressSync.h"
+#include "ProgressStats.h"
+#include "BackgroundCache.h"
+#include "AnswerText.h"
+#include "AppStyle.h"
+#include "MemoryBoard.h"
+#include "FrameMonitor.h"
+#include "HeadwordIndex.h"
+#include "ArcadeField.h"
+#include "PronunciationScorer.h"
+#include "AudioPack.h"
+#include "SpeechCache.h"
+#include "SpeechService.h"
+#include "Trace.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QTimer>
+#include <QDebug>
+#include <functional>
+
+namespace {
+// Calls back once a window has painted its first frame and the event loop
+// is free again, which is when the user can start typing.
+class FirstFrameProbe : public QObject
+{
+public:
+    FirstFrameProbe(QWidget* window, std::function<void()> onInteractive)
+        : QObject(window)
+        , onInteractive(std::move(onInteractive))
+    {
+        window->installEventFilter(this);
+    }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            watched->removeEventFilter(this);
+            QTimer::singleShot(0, this, [this]() { onInteractive(); });
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    std::function<void()> onInteractive;
+};
+}
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startup;
+    startup.start();
+    ELA_TRACE_START(argc, argv);
+    ELA_TRACE_BEGIN(appSpan, "QApplication");
     QApplication a(argc, argv);
+    ELA_TRACE_END(appSpan);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption exportOption("export-progress", "Export the progress of all users to <file>.", "file");
+    QCommandLineOption importOption("import-progress", "Merge the progress stored in <file>.", "file");
+    QCommandLineOption benchArchiveOption("bench-progress-archive", "Benchmark progress export/import with <events> answers.", "events");
+    QCommandLineOption syncExportOption("sync-export", "Write this device's state for offline sync to <file>.", "file");
+    QCommandLineOption syncMergeOption("sync-merge", "Merge the device state in <file>; may be repeated.", "file");
+    QCommandLineOption benchSyncOption("bench-sync", "Benchmark merging a device state with <events> answers.", "events");
+    QCommandLineOption benchStyleOption("bench-style", "Benchmark <changes> widget state changes against per-widget stylesheets.", "changes");
+    QCommandLineOption benchBoardOption("bench-memory-board", "Measure frame times of an animated <columns>x<rows> memory board.", "grid");
+    QCommandLineOption traceOption("trace", "Write startup and navigation spans to <file> in Chrome trace format (needs an ELA_TRACING build).", "file");
+    QCommandLineOption frameStatsOption("frame-stats", "Record memory-game animation frame times; Ctrl+Shift+F or exit prints them.");
+    QCommandLineOption startupTimeOption("startup-time", "Print the time until the login dialog is interactive, then quit.");
+    QCommandLineOption benchArcadeOption("bench-arcade", "Render <words> falling words for 600 frames off screen and report frame time and CPU; add -platform offscreen to run headless.", "words");
+    QCommandLineOption benchSpeechOption("bench-speech", "Synthesize a word once, replay it <replays> times from the speech cache and report replay start latency.", "replays");
+    QCommandLineOption buildPackOption("build-audio-pack", "Synthesize the headwords and examples of <levels> (e.g. 1,2 or all) into audio packs under resources/audio.", "levels");
+    QCommandLineOption packLocaleOption("pack-locale", "Locale of the audio packs to build; he_IL packs Hebrew words (default en_US).", "locale", "en_US");
+    QCommandLineOption packVoiceOption("pack-voice", "Voice of the audio packs to build (default: the engine's voice for the locale).", "name");
+    QCommandLineOption packJobsOption("pack-jobs", "Speech engines to run in parallel when building audio packs (default: one per core).", "count");
+    QCommandLineOption benchPronunciationOption("bench-pronunciation", "Time MFCC extraction and DTW scoring of a 1 s clip over <runs> runs.", "runs");
+    QCommandLineOption scoreOption("score-pronunciation", "Print the pronunciation score of the recording in <wav> against --score-reference.", "wav");
+    QCommandLineOption scoreReferenceOption("score-reference", "Reference for --score-pronunciation: a WAV file, or a word looked up in the en_US audio packs.", "wav-or-word");
+    QCommandLineOption benchNormalizeOption("bench-normalize", "Normalize every dictionary string <rounds> times with the answer kernel and the regex path, and check they agree.", "rounds");
+    QCommandLineOption benchSearchOption("bench-search", "Index the headwords of all levels and time <queries> English, Hebrew and transliterated prefix searches.", "queries");
+    QCommandLineOption checkPoolOption("check-card-pool", "Play <rounds> memory-game rounds and fail if cards or objects accumulate.", "rounds");
+    parser.addOptions({ exportOption, importOption, benchArchiveOption, syncExportOption, syncMergeOption, benchSyncOption, benchStyleOption, benchBoardOption, checkPoolOption, traceOption, frameStatsOption, startupTimeOption, benchArcadeOption, benchSpeechOption,
+                       buildPackOption, packLocaleOption, packVoiceOption, packJobsOption,
+                       benchPronunciationOption, scoreOption, scoreReferenceOption, benchNormalizeOption,
+                       benchSearchOption });
+    parser.process(a);
+
+#ifndef ELA_TRACING
+    if (parser.isSet(traceOption) || qEnvironmentVariableIsSet("ELA_TRACE")) {
+        qWarning() << "Tracing requested, but this build was configured without ELA_TRACING.";
+    }
+#endif
+
+    if (parser.isSet(exportOption) || parser.isSet(importOption)) {
+        QSettings settings("MyCompany", "EnglishLearningApp");
+        ProgressLog log;
+        ProgressArchive archive(settings, log);
+        QString error;
+        bool ok = parser.isSet(exportOption)
+            ? archive.exportTo(parser.value(exportOption), &error)
+            : archive.importFrom(parser.value(importOption), &error);
+        if (!ok) {
+            qCritical() << error;
+        } else if (parser.isSet(importOption)) {
+            ProgressStats::instance().rebuild();
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (parser.isSet(syncExportOption) || parser.isSet(syncMergeOption)) {
+        QSettings settings("MyCompany", "EnglishLearningApp");
+        ProgressLog log;
+        ProgressSync sync(settings, log);
+        QString error;
+        for (const QString& file : parser.values(syncMergeOption)) {
+            if (!sync.mergeState(file, &error)) {
+                qCritical() << file << error;
+                return 1;
+            }
+        }
+        if (parser.isSet(syncMergeOption)) {
+            ProgressStats::instance().rebuild();
+        }
+        if (parser.isSet(syncExportOption) && !sync.exportState(parser.value(syncExportOption), &error)) {
+            qCritical() << error;
+            return 1;
+        }
+        return 0;
+    }
+
+    AppStyle::apply(a);
+
+    if (parser.isSet(frameStatsOption)) {
+        FrameMonitor::setInstrumentationEnabled(true);
+    }
+
+    if (parser.isSet(benchStyleOption)) {
+        AppStyle::runBenchmark(parser.value(benchStyleOption).toInt());
+        return 0;
+    }
+
+    if (parser.isSet(benchBoardOption)) {
+        QStringList grid = parser.value(benchBoardOption).split('x');
+        MemoryBoard::runBenchmark(grid.value(0).toInt(), grid.value(1, grid.value(0)).toInt(), 5000);
+        return 0;
+    }
 
+    if (parser.isSet(benchArcadeOption)) {
+        ArcadeField::runBenchmark(parser.value(benchArcadeOption).toInt(), 600);
+        return 0;
+    }
+
+    if (parser.isSet(benchSpeechOption)) {
+        SpeechCache::runBenchmark(parser.value(benchSpeechOption).toInt());
+        return 0;
+    }
+
+    if (parser.isSet(buildPackOption)) {
+        QStringList levels = parser.value(buildPackOption).split(',', Qt::SkipEmptyParts);
+        if (levels == QStringList { "all" }) {
+            levels = QStringList { "1", "2", "3", "4", "5" };
+        }
+        bool ok = AudioPack::build(levels, QLocale(parser.value(packLocaleOption)),
+                                   parser.value(packVoiceOption), parser.value(packJobsOption).toInt(),
+                                   "resources/audio");
+        return ok ? 0 : 1;
+    }
+
+    if (parser.isSet(benchPronunciationOption)) {
+        PronunciationScorer::runBenchmark(parser.value(benchPronunciationOption).toInt());
+        return 0;
+    }
+
+    if (parser.isSet(scoreOption)) {
+        QVector<float> learner = PronunciationScorer::loadWav(parser.value(scoreOption));
+        QString reference = parser.value(scoreReferenceOption);
+        QVector<float> referenceSamples;
+        QAudioFormat format;
+        QByteArray pcm;
+        if (reference.endsWith(".wav", Qt::CaseInsensitive)) {
+            referenceSamples = PronunciationScorer::loadWav(reference);
+        } else if (AudioPack::find(QLocale(QLocale::English, QLocale::UnitedStates), QString(), reference, format, pcm)) {
+            referenceSamples = PronunciationScorer::toMono(format, pcm);
+        }
+        if (learner.isEmpty() || referenceSamples.isEmpty()) {
+            qCritical() << "Nothing to compare: need a learner WAV and a reference WAV or packed word.";
+            return 1;
+        }
+        qInfo().noquote() << QString("pronunciation score: %1").arg(PronunciationScorer::score(learner, referenceSamples));
+        return 0;
+    }
+
+    if (parser.isSet(benchNormalizeOption)) {
+        AnswerText::runBenchmark(parser.value(benchNormalizeOption).toInt());
+        return 0;
+    }
+
+    if (parser.isSet(benchSearchOption)) {
+        HeadwordIndex::runBenchmark(parser.value(benchSearchOption).toInt());
+        return 0;
+    }
+
+    if (parser.isSet(checkPoolOption)) {
+        return MemoryBoard::runPoolCheck(parser.value(checkPoolOption).toInt()) ? 0 : 1;
+    }
+
+    if (parser.isSet(benchSyncOption)) {
+        ProgressSync::runBenchmark(parser.value(benchSyncOption).toInt());
+        return 0;
+    }
+
+    if (parser.isSet(benchArchiveOption)) {
+        ProgressArchive::runBenchmark(parser.value(benchArchiveOption).toInt());
+        return 0;
+    }
+
+    // Only what the login needs runs before its first frame; speech, sounds
+    // and dictionaries start when a page first uses them.
     UserNameDialog dialog;
-    if (dialog.exec() == QDialog::Accepted) {
+    bool measureOnly = parser.isSet(startupTimeOption);
+    new FirstFrameProbe(&dialog, [&]() {
+        qint64 elapsed = startup.elapsed();
+        if (measureOnly) {
+            qInfo().noquote() << QString("startup: login interactive after %1 ms (target 200 ms)").arg(elapsed);
+            dialog.reject();
+            return;
+        }
+        if (Trace::isEnabled()) {
+            qInfo().noquote() << QString("startup: login interactive after %1 ms").arg(elapsed);
+        }
+        // Composite the other window backgrounds while the user logs in.
+        BackgroundCache::preload(0.3, QSize(600, 400), a.devicePixelRatio());
+        BackgroundCache::preload(0.6, QSize(600, 400), a.devicePixelRatio());
+    });
+    ELA_TRACE_BEGIN(loginSpan, "login (waiting for user)");
+    int result = dialog.exec();
+    ELA_TRACE_END(loginSpan);
+    if (result == QDialog::Accepted) {
         QString userName = dialog.getUserName();
         if (userName.isEmpty()) {
             return 0; 
         }
 
-        MainWindow w;
-        w.setWindowTitle("Hey " + userName);
+        ELA_TRACE_BEGIN(mainSpan, "MainWindow construct and show");
+        MainWindow w(userName);
         w.show();
-        return a.exec();
+        ELA_TRACE_END(mainSpan);
+        // Loads the speech engine while the learner looks at the menu.
+        SpeechService::instance().start();
+        int exitCode = a.exec();
+        if (Trace::isEnabled()) {
+            qInfo().noquote() << SpeechCache::summary();
+        }
+        return exitCode;
     }
     return 0;
 }
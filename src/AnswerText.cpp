@@ -0,0 +1,268 @@
+#include "AnswerText.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QDebug>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ELA_SSE2
+#endif
+
+namespace {
+const char16_t kDrop = 0;        // niqqud and cantillation
+const char16_t kSlow = 0xFFFF;   // needs Unicode case mapping or decomposition
+const int kTableSize = 0x0600;   // up to the end of the Hebrew block
+const char16_t kFinalLetters[] = { 0x05DA, 0x05DD, 0x05DF, 0x05E3, 0x05E5 };   // ךםןףץ
+
+// What each character below U+0600 becomes, with and without final letters
+// folded onto their ordinary forms (ך -> כ and so on, each one code point up).
+// ASCII has no decompositions and the Hebrew block has no precomposed
+// letters, so only the rest of the range goes to the slow path.
+struct Tables
+{
+    char16_t plain[kTableSize];
+    char16_t folded[kTableSize];
+
+    Tables()
+    {
+        for (int c = 0; c < kTableSize; ++c) {
+            char16_t mapped = kSlow;
+            if (c > 0 && c < 0x80) {
+                mapped = (c >= 'A' && c <= 'Z') ? char16_t(c + 0x20) : char16_t(c);
+            } else if (c >= 0x0591 && c <= 0x05C7) {
+                mapped = kDrop;
+            } else if (c >= 0x0590) {
+                mapped = char16_t(c);
+            }
+            plain[c] = mapped;
+            folded[c] = mapped;
+        }
+        for (char16_t c : kFinalLetters) {
+            folded[c] = char16_t(c + 1);
+        }
+    }
+};
+
+const Tables& tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+// Maps in[begin, end) through the table, dropping marks. Returns the new
+// output length, or -1 when a character needs the slow path.
+qsizetype mapScalar(const char16_t* in, qsizetype begin, qsizetype end, char16_t* out, qsizetype o,
+                    const char16_t* table)
+{
+    for (qsizetype i = begin; i < end; ++i) {
+        char16_t c = in[i];
+        char16_t mapped = c < kTableSize ? table[c] : kSlow;
+        if (mapped == kSlow) {
+            return -1;
+        }
+        if (mapped != kDrop) {
+            out[o++] = mapped;
+        }
+    }
+    return o;
+}
+
+// Blocks that are all ASCII or Hebrew letters (U+05D0-U+05FF) keep their
+// length, so they are lowered and folded in registers and stored as they
+// are; any other block, typically one with niqqud, goes through the table.
+// The unsigned compares are done with saturating subtraction: x <= y
+// exactly when x - y saturates to zero.
+#if defined(__AVX2__)
+qsizetype normalizeInto(const char16_t* in, qsizetype n, char16_t* out, bool fold)
+{
+    const char16_t* table = fold ? tables().folded : tables().plain;
+    const __m256i zero = _mm256_setzero_si256();
+    qsizetype i = 0;
+    qsizetype o = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i ascii = _mm256_cmpeq_epi16(_mm256_subs_epu16(v, _mm256_set1_epi16(0x7F)), zero);
+        __m256i nul = _mm256_cmpeq_epi16(v, zero);
+        __m256i hebrew = _mm256_cmpeq_epi16(
+            _mm256_subs_epu16(_mm256_sub_epi16(v, _mm256_set1_epi16(0x05D0)), _mm256_set1_epi16(0x2F)), zero);
+        __m256i plain = _mm256_andnot_si256(nul, _mm256_or_si256(ascii, hebrew));
+        if (uint(_mm256_movemask_epi8(plain)) != 0xFFFFFFFFu) {
+            o = mapScalar(in, i, i + 16, out, o, table);
+            if (o < 0) {
+                return -1;
+            }
+            continue;
+        }
+        __m256i upper = _mm256_cmpeq_epi16(
+            _mm256_subs_epu16(_mm256_sub_epi16(v, _mm256_set1_epi16('A')), _mm256_set1_epi16(25)), zero);
+        v = _mm256_add_epi16(v, _mm256_and_si256(upper, _mm256_set1_epi16(0x20)));
+        if (fold) {
+            for (char16_t c : kFinalLetters) {
+                __m256i isFinal = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(short(c)));
+                v = _mm256_sub_epi16(v, isFinal);
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), v);
+        o += 16;
+    }
+    return mapScalar(in, i, n, out, o, table);
+}
+#elif defined(ELA_SSE2)
+qsizetype normalizeInto(const char16_t* in, qsizetype n, char16_t* out, bool fold)
+{
+    const char16_t* table = fold ? tables().folded : tables().plain;
+    const __m128i zero = _mm_setzero_si128();
+    qsizetype i = 0;
+    qsizetype o = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i ascii = _mm_cmpeq_epi16(_mm_subs_epu16(v, _mm_set1_epi16(0x7F)), zero);
+        __m128i nul = _mm_cmpeq_epi16(v, zero);
+        __m128i hebrew = _mm_cmpeq_epi16(
+            _mm_subs_epu16(_mm_sub_epi16(v, _mm_set1_epi16(0x05D0)), _mm_set1_epi16(0x2F)), zero);
+        __m128i plain = _mm_andnot_si128(nul, _mm_or_si128(ascii, hebrew));
+        if (_mm_movemask_epi8(plain) != 0xFFFF) {
+            o = mapScalar(in, i, i + 8, out, o, table);
+            if (o < 0) {
+                return -1;
+            }
+            continue;
+        }
+        __m128i upper = _mm_cmpeq_epi16(
+            _mm_subs_epu16(_mm_sub_epi16(v, _mm_set1_epi16('A')), _mm_set1_epi16(25)), zero);
+        v = _mm_add_epi16(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+        if (fold) {
+            for (char16_t c : kFinalLetters) {
+                __m128i isFinal = _mm_cmpeq_epi16(v, _mm_set1_epi16(short(c)));
+                v = _mm_sub_epi16(v, isFinal);
+            }
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), v);
+        o += 8;
+    }
+    return mapScalar(in, i, n, out, o, table);
+}
+#else
+qsizetype normalizeInto(const char16_t* in, qsizetype n, char16_t* out, bool fold)
+{
+    return mapScalar(in, 0, n, out, 0, fold ? tables().folded : tables().plain);
+}
+#endif
+
+void foldFinalLetters(QString& text)
+{
+    for (QChar& c : text) {
+        for (char16_t letter : kFinalLetters) {
+            if (c.unicode() == letter) {
+                c = QChar(char16_t(letter + 1));
+            }
+        }
+    }
+}
+}
+
+QString AnswerText::removeHebrewDiacritics(const QString& text)
+{
+    static QRegularExpression diacriticsRegex(QString::fromUtf8("[\\u0591-\\u05C7\\u05B0-\\u05BC\\u05C1-\\u05C2\\u05C4-\\u05C5\\u05C7]"));
+    return text.normalized(QString::NormalizationForm_D).remove(diacriticsRegex);
+}
+
+QString AnswerText::normalize(const QString& text, bool foldFinalForms)
+{
+    QString result(text.size(), Qt::Uninitialized);
+    qsizetype length = normalizeInto(reinterpret_cast<const char16_t*>(text.utf16()), text.size(),
+                                     reinterpret_cast<char16_t*>(result.data()), foldFinalForms);
+    if (length < 0) {
+        result = removeHebrewDiacritics(text.toLower());
+        if (foldFinalForms) {
+            foldFinalLetters(result);
+        }
+        return result;
+    }
+    result.truncate(length);
+    return result;
+}
+
+bool AnswerText::isHebrew(QChar c)
+{
+    return c.unicode() >= 0x0590 && c.unicode() <= 0x05FF;
+}
+
+QString AnswerText::keyboardWarning(const QString& typed, bool expectHebrew)
+{
+    if (typed.isEmpty() || isHebrew(typed.back()) == expectHebrew) {
+        return QString();
+    }
+    return expectHebrew ? "נא החלף למקלדת עברית" : "נא החלף למקלדת אנגלית";
+}
+
+void AnswerText::runBenchmark(int rounds)
+{
+    // Every headword, translation and example of every level, niqqud and all.
+    QStringList corpus;
+    for (int level = 1; level <= 5; ++level) {
+        QFile file(QString("resources/dictionary_level%1_enhanced.json").arg(level));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const QJsonObject words = QJsonDocument::fromJson(file.readAll()).object();
+        for (auto it = words.begin(); it != words.end(); ++it) {
+            const QJsonObject word = it.value().toObject();
+            corpus << it.key() << word["translation"].toString()
+                   << word["ex_en"].toString() << word["ex_he"].toString();
+        }
+    }
+    if (corpus.isEmpty()) {
+        qWarning() << "No dictionaries found under resources/";
+        return;
+    }
+
+    int mismatches = 0;
+    for (const QString& text : corpus) {
+        if (normalize(text) != removeHebrewDiacritics(text.toLower())) {
+            qWarning() << "normalize() differs from the regex path on" << text;
+            ++mismatches;
+        }
+    }
+
+    rounds = qMax(1, rounds);
+    QElapsedTimer timer;
+    qsizetype checksum = 0;
+    timer.start();
+    for (int round = 0; round < rounds; ++round) {
+        for (const QString& text : corpus) {
+            checksum += removeHebrewDiacritics(text.toLower()).size();
+        }
+    }
+    qint64 regexNs = timer.nsecsElapsed();
+    timer.start();
+    for (int round = 0; round < rounds; ++round) {
+        for (const QString& text : corpus) {
+            checksum += normalize(text).size();
+        }
+    }
+    qint64 kernelNs = timer.nsecsElapsed();
+    Q_UNUSED(checksum);
+
+#if defined(__AVX2__)
+    const char* path = "AVX2";
+#elif defined(ELA_SSE2)
+    const char* path = "SSE2";
+#else
+    const char* path = "scalar";
+#endif
+    const double calls = double(rounds) * corpus.size();
+    qInfo().noquote() << QString("normalize: %1 strings, regex path %2 us each, %3 kernel %4 us each (%5x); %6 mismatches")
+        .arg(corpus.size())
+        .arg(regexNs / 1000.0 / calls, 0, 'f', 3)
+        .arg(path)
+        .arg(kernelNs / 1000.0 / calls, 0, 'f', 3)
+        .arg(kernelNs > 0 ? double(regexNs) / kernelNs : 0.0, 0, 'f', 1)
+        .arg(mismatches);
+}
@@ -0,0 +1,82 @@
+#include "AnswerTrie.h"
+
+namespace {
+quint64 edgeKey(int node, QChar c)
+{
+    return (quint64(node) << 32) | c.unicode();
+}
+
+bool isHebrewMark(QChar c)
+{
+    return c.unicode() >= 0x0591 && c.unicode() <= 0x05C7;
+}
+}
+
+AnswerTrie::AnswerTrie()
+    : nodeCount(1)
+{
+}
+
+void AnswerTrie::clear()
+{
+    edges.clear();
+    nodeCount = 1;
+}
+
+void AnswerTrie::insert(const QString& answer)
+{
+    int node = 0;
+    for (QChar c : answer) {
+        auto it = edges.constFind(edgeKey(node, c));
+        if (it != edges.constEnd()) {
+            node = it.value();
+        } else {
+            edges.insert(edgeKey(node, c), nodeCount);
+            node = nodeCount++;
+        }
+    }
+}
+
+int AnswerTrie::find(QStringView typed) const
+{
+    int node = 0;
+    for (QChar c : typed.trimmed()) {
+        node = advance(node, c);
+        if (node == kNoMatch) {
+            break;
+        }
+    }
+    return node;
+}
+
+int AnswerTrie::size() const
+{
+    return nodeCount;
+}
+
+int AnswerTrie::advance(int node, QChar c) const
+{
+    // The steps of AnswerText::normalize(), one character at a time:
+    // lower case, canonical decomposition, then drop niqqud and cantillation.
+    QChar lower = c.toLower();
+    if (lower.decompositionTag() != QChar::Canonical) {
+        return step(node, lower);
+    }
+    // Precomposed letters are rare in typed answers; only they allocate.
+    const QString decomposed = QString(lower).normalized(QString::NormalizationForm_D);
+    for (QChar part : decomposed) {
+        node = step(node, part);
+        if (node == kNoMatch) {
+            break;
+        }
+    }
+    return node;
+}
+
+int AnswerTrie::step(int node, QChar c) const
+{
+    if (isHebrewMark(c)) {
+        return node;
+    }
+    return edges.value(edgeKey(node, c), kNoMatch);
+}
@@ -0,0 +1,84 @@
+#include "AppStyle.h"
+#include "Trace.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLabel>
+#include <QStyle>
+#include <QVBoxLayout>
+#include <QDebug>
+
+void AppStyle::apply(QApplication& app)
+{
+    ELA_TRACE_SCOPE("AppStyle::apply");
+    QFile file(":/style.qss");
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not load the application stylesheet";
+        return;
+    }
+    app.setStyleSheet(QString::fromUtf8(file.readAll()));
+}
+
+void AppStyle::setRole(QWidget* widget, const char* role)
+{
+    widget->setProperty("role", QString::fromLatin1(role));
+}
+
+void AppStyle::setState(QWidget* widget, const char* property, const QString& value)
+{
+    if (widget->property(property).toString() == value) {
+        return;
+    }
+    widget->setProperty(property, value);
+    widget->style()->unpolish(widget);
+    widget->style()->polish(widget);
+    widget->update();
+}
+
+void AppStyle::runBenchmark(int iterations)
+{
+    QWidget host;
+    QVBoxLayout* layout = new QVBoxLayout(&host);
+    QList<QLabel*> labels;
+    for (int i = 0; i < 20; ++i) {
+        QLabel* label = new QLabel(QString("feedback %1").arg(i), &host);
+        setRole(label, "feedback");
+        layout->addWidget(label);
+        labels.append(label);
+    }
+    host.ensurePolished();
+
+    // What GameWindow used to hand its feedback label on each change.
+    auto legacyStyle = [](const QString& color) {
+        return QString(
+            "color: %1;"
+            "font-weight: bold;"
+            "font-size: 16px;"
+        ).arg(color);
+    };
+
+    // Each label alternates between two states on successive visits.
+    auto warning = [&labels](int i) { return (i / labels.size()) % 2 == 1; };
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        labels[i % labels.size()]->setStyleSheet(legacyStyle(warning(i) ? "red" : "black"));
+    }
+    qint64 legacyNs = timer.nsecsElapsed();
+    for (QLabel* label : labels) {
+        label->setStyleSheet(QString());
+    }
+
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        setState(labels[i % labels.size()], "feedback", warning(i) ? "warning" : "example");
+    }
+    qint64 propertyNs = timer.nsecsElapsed();
+
+    int n = qMax(iterations, 1);
+    qInfo().noquote() << QString("style: %1 state changes, setStyleSheet %2 us each, property + polish %3 us each (%4x)")
+        .arg(iterations)
+        .arg(legacyNs / 1000.0 / n, 0, 'f', 1)
+        .arg(propertyNs / 1000.0 / n, 0, 'f', 1)
+        .arg(propertyNs > 0 ? double(legacyNs) / propertyNs : 0.0, 0, 'f', 1);
+}
@@ -0,0 +1,266 @@
+#include "ArcadeField.h"
+#include "AnswerText.h"
+#include <QImage>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QDebug>
+#include <ctime>
+
+namespace {
+const QColor kFieldColor("#fff8dc");
+const QColor kWordColor("#ebbf00");
+const qreal kPaddingX = 10;
+const qreal kPaddingY = 5;
+const qreal kRadius = 8;
+const qreal kBaseSpeed = 35;       // pixels per second at level 1
+const qreal kSpeedPerLevel = 12;
+const qreal kBaseSpawnSeconds = 2.2;
+const qreal kMinSpawnSeconds = 0.6;
+const int kWordsPerLevel = 8;
+}
+
+ArcadeField::ArcadeField(QWidget* parent)
+    : QWidget(parent)
+    , random(QRandomGenerator::global()->generate())
+{
+    // paintEvent covers every pixel it is asked for, so Qt need not clear.
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(300, 200);
+
+    font.setPixelSize(20);
+    font.setBold(true);
+
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    frameTimer.setInterval(16);
+    connect(&frameTimer, &QTimer::timeout, this, &ArcadeField::tick);
+}
+
+void ArcadeField::setWords(const QList<QPair<QString, QString>>& pairs)
+{
+    this->pairs = pairs;
+}
+
+void ArcadeField::start()
+{
+    if (pairs.isEmpty() || frameTimer.isActive()) {
+        return;
+    }
+    frameClock.start();
+    lastFrameNs = 0;
+    frameTimer.start();
+}
+
+void ArcadeField::stop()
+{
+    frameTimer.stop();
+}
+
+void ArcadeField::clear()
+{
+    stop();
+    words.clear();
+    cleared = 0;
+    untilSpawn = 0;
+    update();
+}
+
+bool ArcadeField::isRunning() const
+{
+    return frameTimer.isActive();
+}
+
+int ArcadeField::level() const
+{
+    return 1 + cleared / kWordsPerLevel;
+}
+
+bool ArcadeField::tryAnswer(const QString& typed)
+{
+    QString answer = AnswerText::normalize(typed.trimmed());
+    if (answer.isEmpty()) {
+        return false;
+    }
+
+    int lowest = -1;
+    for (int i = 0; i < words.size(); ++i) {
+        if (words[i].normalizedAnswer == answer
+            && (lowest < 0 || words[i].rect.bottom() > words[lowest].rect.bottom())) {
+            lowest = i;
+        }
+    }
+    if (lowest < 0) {
+        return false;
+    }
+
+    Word word = words.takeAt(lowest);
+    update(dirtyRect(word.rect));
+    ++cleared;
+    emit wordCleared(word.prompt, word.answer);
+    return true;
+}
+
+void ArcadeField::tick()
+{
+    qint64 now = frameClock.nsecsElapsed();
+    // A stalled event loop should not teleport every word to the floor.
+    qreal seconds = qMin((now - lastFrameNs) / 1e9, 0.1);
+    lastFrameNs = now;
+
+    QRegion dirty = advance(seconds);
+    if (!dirty.isEmpty()) {
+        update(dirty);
+    }
+}
+
+QRegion ArcadeField::advance(qreal seconds)
+{
+    QRegion dirty;
+    QList<Word> missed;
+
+    for (int i = words.size() - 1; i >= 0; --i) {
+        Word& word = words[i];
+        QRectF before = word.rect;
+        word.rect.translate(0, word.speed * seconds);
+        if (word.rect.top() >= height()) {
+            dirty += dirtyRect(before);
+            missed.append(words.takeAt(i));
+            continue;
+        }
+        // Old and new positions overlap, so one rectangle covers both.
+        dirty += dirtyRect(before.united(word.rect));
+    }
+
+    untilSpawn -= seconds;
+    if (untilSpawn <= 0 && !pairs.isEmpty()) {
+        dirty += spawn();
+        untilSpawn = qMax(kMinSpawnSeconds, kBaseSpawnSeconds - 0.2 * (level() - 1));
+    }
+
+    for (const Word& word : missed) {
+        emit wordMissed(word.prompt, word.answer);
+    }
+    return dirty;
+}
+
+QRect ArcadeField::spawn()
+{
+    const QPair<QString, QString>& pair = pairs.at(random.bounded(pairs.size()));
+
+    Word word;
+    word.prompt = pair.first;
+    word.answer = pair.second;
+    word.normalizedAnswer = AnswerText::normalize(pair.second);
+    word.text.setText(pair.first);
+    word.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    word.text.prepare(QTransform(), font);
+
+    QSizeF size = word.text.size() + QSizeF(2 * kPaddingX, 2 * kPaddingY);
+    qreal x = random.bounded(qMax(1.0, width() - size.width()));
+    word.rect = QRectF(QPointF(x, -size.height()), size);
+    word.speed = (kBaseSpeed + kSpeedPerLevel * (level() - 1)) * (0.8 + 0.4 * random.generateDouble());
+
+    words.append(word);
+    return dirtyRect(word.rect);
+}
+
+QRect ArcadeField::dirtyRect(const QRectF& rect)
+{
+    // One extra pixel for antialiased edges.
+    return rect.toAlignedRect().adjusted(-1, -1, 1, 1);
+}
+
+void ArcadeField::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    paintField(painter, event->region());
+}
+
+void ArcadeField::paintField(QPainter& painter, const QRegion& region) const
+{
+    for (const QRect& rect : region) {
+        painter.fillRect(rect, kFieldColor);
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(font);
+    for (const Word& word : words) {
+        if (!region.intersects(dirtyRect(word.rect))) {
+            continue;
+        }
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(kWordColor);
+        painter.drawRoundedRect(word.rect, kRadius, kRadius);
+        painter.setPen(Qt::black);
+        painter.drawStaticText(word.rect.topLeft() + QPointF(kPaddingX, kPaddingY), word.text);
+    }
+}
+
+void ArcadeField::runBenchmark(int wordCount, int frames)
+{
+    wordCount = qMax(1, wordCount);
+    frames = qMax(1, frames);
+
+    QList<QPair<QString, QString>> pairs;
+    for (int i = 0; i < 200; ++i) {
+        pairs.append(qMakePair(QString("מילה %1").arg(i), QString("word %1").arg(i)));
+    }
+
+    struct Result {
+        double wallMs;
+        double cpuMs;
+        qint64 pixels;
+    };
+
+    auto run = [&](bool fullRepaint) {
+        ArcadeField field;
+        field.resize(600, 300);
+        field.setWords(pairs);
+        field.random.seed(40);
+        // Start with the field already full rather than waiting for it to fill.
+        while (field.words.size() < wordCount) {
+            field.spawn();
+            field.words.last().rect.moveTop(field.random.bounded(field.height()));
+        }
+
+        QImage image(field.size(), QImage::Format_ARGB32_Premultiplied);
+        const QRegion everything(field.rect());
+        Result result { 0, 0, 0 };
+
+        QElapsedTimer wall;
+        wall.start();
+        std::clock_t cpuStart = std::clock();
+        for (int i = 0; i < frames; ++i) {
+            QRegion dirty = field.advance(1.0 / 60);
+            // Missed words come back at once so the load stays constant.
+            while (field.words.size() < wordCount) {
+                dirty += field.spawn();
+            }
+            if (fullRepaint) {
+                dirty = everything;
+            }
+            QPainter painter(&image);
+            field.paintField(painter, dirty);
+            painter.end();
+            for (const QRect& rect : dirty) {
+                result.pixels += qint64(rect.width()) * rect.height();
+            }
+        }
+        result.wallMs = wall.nsecsElapsed() / 1e6;
+        // std::clock() is process CPU time on POSIX; on Windows it is wall time.
+        result.cpuMs = double(std::clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC;
+        return result;
+    };
+
+    Result dirty = run(false);
+    Result full = run(true);
+    qint64 fieldPixels = 600 * 300;
+
+    qInfo().noquote() << QString("arcade %1 words, %2 frames: dirty rects %3 ms/frame (%4 fps possible, CPU %5 ms/frame, %6% of field); full repaint %7 ms/frame (%8 fps possible)")
+        .arg(wordCount).arg(frames)
+        .arg(dirty.wallMs / frames, 0, 'f', 3)
+        .arg(frames * 1000.0 / dirty.wallMs, 0, 'f', 0)
+        .arg(dirty.cpuMs / frames, 0, 'f', 3)
+        .arg(100.0 * dirty.pixels / (double(fieldPixels) * frames), 0, 'f', 1)
+        .arg(full.wallMs / frames, 0, 'f', 3)
+        .arg(frames * 1000.0 / full.wallMs, 0, 'f', 0);
+}
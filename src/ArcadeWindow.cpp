@@ -0,0 +1,198 @@
+#include "ArcadeWindow.h"
+#include "AnswerText.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
+#include "ProgressLog.h"
+#include "SoundBank.h"
+#include "Trace.h"
+#include <QFile>
+#include <QHBoxLayout>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMessageBox>
+#include <QVBoxLayout>
+#include <QDebug>
+
+ArcadeWindow::ArcadeWindow(QWidget* parent)
+    : QWidget(parent)
+    , field(new ArcadeField(this))
+    , answerEdit(new QLineEdit(this))
+    , statusLabel(new QLabel(this))
+    , feedbackLabel(new QLabel(this))
+    , restartButton(new QPushButton("שחק שוב", this))
+    , backButton(new QPushButton("חזרה", this))
+{
+    ELA_TRACE_SCOPE("ArcadeWindow::ArcadeWindow");
+    setWindowTitle("מילים נופלות");
+
+    QLabel* imageLabel = new QLabel(this);
+    imageLabel->setScaledContents(true);
+    BackgroundCache::applyTo(imageLabel, 0.6, QSize(600, 400));
+    imageLabel->setGeometry(0, 0, 600, 400);
+    imageLabel->lower();
+
+    AppStyle::setRole(statusLabel, "status");
+    statusLabel->setAlignment(Qt::AlignCenter);
+    AppStyle::setRole(feedbackLabel, "feedback");
+    feedbackLabel->setAlignment(Qt::AlignCenter);
+
+    answerEdit->setPlaceholderText("הקלד את התרגום באנגלית");
+    AppStyle::setRole(answerEdit, "answer");
+
+    AppStyle::setRole(restartButton, "gold");
+    AppStyle::setRole(backButton, "gold");
+    restartButton->hide();
+
+    QHBoxLayout* inputLayout = new QHBoxLayout();
+    inputLayout->addWidget(backButton);
+    inputLayout->addWidget(answerEdit, 1);
+    inputLayout->addWidget(restartButton);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(statusLabel);
+    mainLayout->addWidget(field, 1);
+    mainLayout->addWidget(feedbackLabel);
+    mainLayout->addLayout(inputLayout);
+
+    connect(answerEdit, &QLineEdit::textChanged, this, &ArcadeWindow::checkTyping);
+    connect(answerEdit, &QLineEdit::returnPressed, this, &ArcadeWindow::submitAnswer);
+    connect(field, &ArcadeField::wordCleared, this, &ArcadeWindow::wordCleared);
+    connect(field, &ArcadeField::wordMissed, this, &ArcadeWindow::wordMissed);
+    connect(restartButton, &QPushButton::clicked, this, &ArcadeWindow::restart);
+    connect(backButton, &QPushButton::clicked, this, &ArcadeWindow::goBack);
+}
+
+void ArcadeWindow::start(const QString& jsonFile)
+{
+    if (jsonFile != this->jsonFile || pairs.isEmpty()) {
+        this->jsonFile = jsonFile;
+        loadWords(jsonFile);
+    }
+    restart();
+}
+
+void ArcadeWindow::loadWords(const QString& jsonFile)
+{
+    ELA_TRACE_SCOPE("ArcadeWindow::loadWords");
+    QString fileName = jsonFile;
+    fileName.replace(".json", "_enhanced.json");
+    QString filePath = QString("resources/%1").arg(fileName);
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open words JSON file:" << filePath;
+        QMessageBox::critical(this, "Error", QString("Failed to load dictionary file: %1").arg(filePath));
+        return;
+    }
+
+    pairs.clear();
+    QJsonObject words = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = words.begin(); it != words.end(); ++it) {
+        QString hebrewWord = AnswerText::removeHebrewDiacritics(it.value().toObject()["translation"].toString());
+        if (!hebrewWord.isEmpty()) {
+            pairs.append(qMakePair(hebrewWord, it.key()));
+        }
+    }
+    field->setWords(pairs);
+}
+
+void ArcadeWindow::restart()
+{
+    score = 0;
+    lives = kLives;
+    field->clear();
+    answerEdit->clear();
+    answerEdit->setEnabled(true);
+    feedbackLabel->clear();
+    restartButton->hide();
+    updateStatus();
+    if (isVisible()) {
+        field->start();
+        answerEdit->setFocus();
+    }
+}
+
+void ArcadeWindow::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    if (lives > 0) {
+        field->start();
+        answerEdit->setFocus();
+    }
+}
+
+void ArcadeWindow::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    field->stop();
+}
+
+void ArcadeWindow::checkTyping()
+{
+    QString text = answerEdit->text();
+    if (field->tryAnswer(text)) {
+        answerEdit->clear();
+        return;
+    }
+
+    QString warning = AnswerText::keyboardWarning(text, false);
+    if (!warning.isEmpty()) {
+        feedbackLabel->setText(warning);
+        AppStyle::setState(feedbackLabel, "feedback", "warning");
+    } else if (!text.isEmpty()) {
+        feedbackLabel->clear();
+    }
+}
+
+void ArcadeWindow::submitAnswer()
+{
+    // A match clears on the keystroke that completes it, so Enter only
+    // ever sees a word that is not on screen.
+    if (answerEdit->text().trimmed().isEmpty()) {
+        return;
+    }
+    feedbackLabel->setText("אין מילה כזו על המסך");
+    AppStyle::setState(feedbackLabel, "feedback", "wrong");
+    answerEdit->clear();
+}
+
+void ArcadeWindow::wordCleared(const QString& prompt, const QString& answer)
+{
+    Q_UNUSED(prompt);
+    ++score;
+    ProgressLog::record("Arcade", jsonFile, answer, true);
+    SoundBank::instance().play(SoundBank::Match);
+    feedbackLabel->setText("✓ " + answer);
+    AppStyle::setState(feedbackLabel, "feedback", "correct");
+    updateStatus();
+}
+
+void ArcadeWindow::wordMissed(const QString& prompt, const QString& answer)
+{
+    ProgressLog::record("Arcade", jsonFile, answer, false);
+    SoundBank::instance().play(SoundBank::Mismatch);
+    feedbackLabel->setText(QString("%1 = %2").arg(prompt, answer));
+    AppStyle::setState(feedbackLabel, "feedback", "answer");
+
+    if (--lives <= 0) {
+        field->stop();
+        answerEdit->setEnabled(false);
+        restartButton->show();
+        feedbackLabel->setText(QString("המשחק נגמר! ניקוד: %1").arg(score));
+    }
+    updateStatus();
+}
+
+void ArcadeWindow::updateStatus()
+{
+    statusLabel->setText(QString("ניקוד: %1   רמה: %2   %3")
+        .arg(score)
+        .arg(field->level())
+        .arg(QString("❤").repeated(qMax(0, lives))));
+}
+
+void ArcadeWindow::goBack()
+{
+    field->stop();
+    emit finished();
+}
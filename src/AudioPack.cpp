@@ -0,0 +1,403 @@
+#include "AudioPack.h"
+#include <QAtomicInt>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextToSpeech>
+#include <QThread>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+const quint32 kPackMagic = 0x454C4150; // "ELAP"
+const quint16 kPackVersion = 1;
+const qint64 kHeaderBytes = 32;
+const qint64 kEntryBytes = 24;
+const QString kPackDirectory = "resources/audio";
+
+// Header (little endian):
+//   0 magic u32, 4 version u16, 6 sample format u16, 8 sample rate u32,
+//  12 channels u16, 14 reserved u16, 16 entry count u32, 20 meta bytes u32,
+//  24 index offset u64, 32 meta: engine, voice and locale joined by 0x1f.
+// Index entry: 0 text offset u64, 8 text bytes u32, 12 pcm bytes u32,
+//  16 pcm offset u64.
+
+template <typename T>
+void append(QByteArray& out, T value)
+{
+    T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&le), sizeof(le));
+}
+
+qint64 align8(qint64 offset)
+{
+    return (offset + 7) & ~qint64(7);
+}
+
+QString fileNameFor(const QString& level, const QLocale& locale, const QString& voiceName)
+{
+    QString name = QString("level%1-%2").arg(level, locale.name());
+    if (!voiceName.isEmpty()) {
+        QString voice = voiceName;
+        for (QChar& c : voice) {
+            if (!c.isLetterOrNumber()) {
+                c = '_';
+            }
+        }
+        name += "-" + voice;
+    }
+    return name + ".elapack";
+}
+
+bool fail(QString* error, const QString& message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+}
+
+AudioPack::AudioPack()
+    : data(nullptr)
+    , length(0)
+    , entryCount(0)
+    , index(nullptr)
+{
+}
+
+AudioPack::~AudioPack()
+{
+    if (data) {
+        file.unmap(const_cast<uchar*>(data));
+    }
+}
+
+bool AudioPack::open(const QString& path, QString* error)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, "Could not open " + path);
+    }
+    length = file.size();
+    if (length < kHeaderBytes) {
+        return fail(error, "Not an audio pack: " + path);
+    }
+    data = file.map(0, length);
+    if (!data) {
+        return fail(error, "Could not map " + path);
+    }
+
+    if (qFromLittleEndian<quint32>(data) != kPackMagic || qFromLittleEndian<quint16>(data + 4) != kPackVersion) {
+        return fail(error, "Not an audio pack: " + path);
+    }
+    packFormat.setSampleFormat(QAudioFormat::SampleFormat(qFromLittleEndian<quint16>(data + 6)));
+    packFormat.setSampleRate(qFromLittleEndian<quint32>(data + 8));
+    packFormat.setChannelCount(qFromLittleEndian<quint16>(data + 12));
+    entryCount = qFromLittleEndian<quint32>(data + 16);
+    quint32 metaBytes = qFromLittleEndian<quint32>(data + 20);
+    quint64 indexOffset = qFromLittleEndian<quint64>(data + 24);
+    if (kHeaderBytes + metaBytes > quint64(length)
+        || indexOffset + quint64(entryCount) * kEntryBytes > quint64(length)) {
+        return fail(error, "Truncated audio pack: " + path);
+    }
+
+    QStringList meta = QString::fromUtf8(reinterpret_cast<const char*>(data + kHeaderBytes), metaBytes)
+                           .split(QChar(0x1f));
+    voice = meta.value(1);
+    packLocale = QLocale(meta.value(2));
+    index = data + indexOffset;
+
+    // Checked once here so clip() can trust every offset.
+    for (quint32 i = 0; i < entryCount; ++i) {
+        const uchar* entry = index + i * kEntryBytes;
+        quint64 textEnd = qFromLittleEndian<quint64>(entry) + qFromLittleEndian<quint32>(entry + 8);
+        quint64 pcmEnd = qFromLittleEndian<quint64>(entry + 16) + qFromLittleEndian<quint32>(entry + 12);
+        if (textEnd > quint64(length) || pcmEnd > quint64(length)) {
+            return fail(error, "Corrupt audio pack index: " + path);
+        }
+    }
+    return true;
+}
+
+QString AudioPack::voiceName() const
+{
+    return voice;
+}
+
+QLocale AudioPack::locale() const
+{
+    return packLocale;
+}
+
+QAudioFormat AudioPack::format() const
+{
+    return packFormat;
+}
+
+int AudioPack::size() const
+{
+    return int(entryCount);
+}
+
+QByteArray AudioPack::clip(const QString& text) const
+{
+    const QByteArray key = text.toUtf8();
+    quint32 low = 0;
+    quint32 high = entryCount;
+    while (low < high) {
+        quint32 mid = low + (high - low) / 2;
+        const uchar* entry = index + mid * kEntryBytes;
+        const char* entryText = reinterpret_cast<const char*>(data + qFromLittleEndian<quint64>(entry));
+        quint32 entryBytes = qFromLittleEndian<quint32>(entry + 8);
+
+        int cmp = std::memcmp(key.constData(), entryText, qMin<qsizetype>(key.size(), entryBytes));
+        if (cmp == 0) {
+            cmp = key.size() < qsizetype(entryBytes) ? -1 : (key.size() > qsizetype(entryBytes) ? 1 : 0);
+        }
+        if (cmp == 0) {
+            return QByteArray::fromRawData(reinterpret_cast<const char*>(data + qFromLittleEndian<quint64>(entry + 16)),
+                                           qFromLittleEndian<quint32>(entry + 12));
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return QByteArray();
+}
+
+bool AudioPack::find(const QLocale& locale, const QString& voiceName, const QString& text,
+                     QAudioFormat& format, QByteArray& pcm)
+{
+    // Mapped for the life of the process; the OS pages in what is played.
+    static QList<AudioPack*> packs = []() {
+        QList<AudioPack*> opened;
+        const QStringList files = QDir(kPackDirectory).entryList({ "*.elapack" }, QDir::Files, QDir::Name);
+        for (const QString& name : files) {
+            AudioPack* pack = new AudioPack;
+            QString error;
+            if (pack->open(kPackDirectory + "/" + name, &error)) {
+                opened.append(pack);
+            } else {
+                qWarning() << error;
+                delete pack;
+            }
+        }
+        return opened;
+    }();
+
+    for (const AudioPack* pack : packs) {
+        if (pack->packLocale != locale || pack->voice != voiceName) {
+            continue;
+        }
+        QByteArray found = pack->clip(text);
+        if (!found.isEmpty()) {
+            format = pack->packFormat;
+            pcm = found;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AudioPack::write(const QString& path, const QString& engine, const QString& voiceName,
+                      const QLocale& locale, const QAudioFormat& format,
+                      QList<QPair<QString, QByteArray>> clips, QString* error)
+{
+    // Sorted by UTF-8 bytes, the order clip() searches in.
+    QList<QPair<QByteArray, QByteArray>> entries;
+    for (const auto& clip : clips) {
+        entries.append(qMakePair(clip.first.toUtf8(), clip.second));
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const auto& a, const auto& b) { return a.first == b.first; }),
+                  entries.end());
+
+    const QByteArray meta = QStringList { engine, voiceName, locale.name() }.join(QChar(0x1f)).toUtf8();
+    const qint64 indexOffset = align8(kHeaderBytes + meta.size());
+    const qint64 textOffset = indexOffset + entries.size() * kEntryBytes;
+    qint64 textBytes = 0;
+    for (const auto& entry : entries) {
+        textBytes += entry.first.size();
+    }
+
+    QByteArray head;
+    append<quint32>(head, kPackMagic);
+    append<quint16>(head, kPackVersion);
+    append<quint16>(head, quint16(format.sampleFormat()));
+    append<quint32>(head, quint32(format.sampleRate()));
+    append<quint16>(head, quint16(format.channelCount()));
+    append<quint16>(head, 0);
+    append<quint32>(head, quint32(entries.size()));
+    append<quint32>(head, quint32(meta.size()));
+    append<quint64>(head, quint64(indexOffset));
+    head.append(meta);
+    head.append(QByteArray(indexOffset - head.size(), '\0'));
+
+    QByteArray texts;
+    qint64 pcmOffset = align8(textOffset + textBytes);
+    for (const auto& entry : entries) {
+        append<quint64>(head, quint64(textOffset + texts.size()));
+        append<quint32>(head, quint32(entry.first.size()));
+        append<quint32>(head, quint32(entry.second.size()));
+        append<quint64>(head, quint64(pcmOffset));
+        texts.append(entry.first);
+        pcmOffset = align8(pcmOffset + entry.second.size());
+    }
+    head.append(texts);
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        return fail(error, "Could not write " + path);
+    }
+    out.write(head);
+    qint64 written = head.size();
+    for (const auto& entry : entries) {
+        out.write(QByteArray(align8(written) - written, '\0'));
+        written = align8(written);
+        out.write(entry.second);
+        written += entry.second.size();
+    }
+    if (!out.commit()) {
+        return fail(error, "Could not write " + path);
+    }
+    return true;
+}
+
+bool AudioPack::build(const QStringList& levels, const QLocale& locale, const QString& voiceName,
+                      int jobs, const QString& outputDir)
+{
+    jobs = jobs > 0 ? jobs : QThread::idealThreadCount();
+
+    QString engineName;
+    {
+        QTextToSpeech probe;
+        if (!probe.engineCapabilities().testFlag(QTextToSpeech::Capability::Synthesize)) {
+            qCritical().noquote() << QString("Speech engine '%1' cannot synthesize to PCM.").arg(probe.engine());
+            return false;
+        }
+        engineName = probe.engine();
+        probe.setLocale(locale);
+        if (!voiceName.isEmpty() && probe.findVoices(voiceName).isEmpty()) {
+            qCritical().noquote() << QString("No voice named '%1'.").arg(voiceName);
+            return false;
+        }
+    }
+    QDir().mkpath(outputDir);
+    const bool english = locale.language() == QLocale::English;
+
+    for (const QString& level : levels) {
+        QFile dictionary(QString("resources/dictionary_level%1_enhanced.json").arg(level));
+        if (!dictionary.open(QIODevice::ReadOnly)) {
+            qCritical() << "Could not open" << dictionary.fileName();
+            return false;
+        }
+        const QJsonObject words = QJsonDocument::fromJson(dictionary.readAll()).object();
+
+        QStringList texts;
+        QSet<QString> seen;
+        for (auto it = words.begin(); it != words.end(); ++it) {
+            QJsonObject entry = it.value().toObject();
+            QStringList candidates = english
+                ? QStringList { it.key(), entry.value("ex_en").toString() }
+                : QStringList { entry.value("translation").toString(), entry.value("ex_he").toString() };
+            for (const QString& text : candidates) {
+                if (!text.isEmpty() && !seen.contains(text)) {
+                    seen.insert(text);
+                    texts.append(text);
+                }
+            }
+        }
+
+        // Each engine lives in its own thread and takes the next text when
+        // it is done; results land in their own slot, so no locking.
+        std::vector<QByteArray> pcm(texts.size());
+        std::vector<QAudioFormat> formats(texts.size());
+        QAtomicInt next(0);
+        auto worker = [&]() {
+            QTextToSpeech engine;
+            engine.setLocale(locale);
+            if (!voiceName.isEmpty()) {
+                engine.setVoice(engine.findVoices(voiceName).value(0));
+            }
+            QEventLoop loop;
+            bool done = false;
+            QObject::connect(&engine, &QTextToSpeech::stateChanged, &loop, [&](QTextToSpeech::State state) {
+                if (state != QTextToSpeech::Synthesizing) {
+                    done = true;
+                    loop.quit();
+                }
+            });
+            for (int i = next.fetchAndAddRelaxed(1); i < texts.size(); i = next.fetchAndAddRelaxed(1)) {
+                done = false;
+                engine.synthesize(texts.at(i), &engine, [&, i](const QAudioFormat& format, const QByteArray& bytes) {
+                    formats[i] = format;
+                    pcm[i].append(bytes);
+                });
+                if (!done) {
+                    loop.exec();
+                }
+            }
+        };
+
+        QElapsedTimer timer;
+        timer.start();
+        QList<QThread*> threads;
+        for (int j = 0; j < jobs; ++j) {
+            threads.append(QThread::create(worker));
+            threads.last()->start();
+        }
+        for (QThread* thread : threads) {
+            thread->wait();
+            delete thread;
+        }
+        double seconds = timer.nsecsElapsed() / 1e9;
+
+        QList<QPair<QString, QByteArray>> clips;
+        QAudioFormat format;
+        int failed = 0;
+        for (int i = 0; i < texts.size(); ++i) {
+            if (pcm[i].isEmpty()) {
+                ++failed;
+                continue;
+            }
+            if (!format.isValid()) {
+                format = formats[i];
+            }
+            // One format per pack; the odd clip out is left to live speech.
+            if (formats[i] != format) {
+                ++failed;
+                continue;
+            }
+            clips.append(qMakePair(texts.at(i), pcm[i]));
+        }
+
+        QString path = outputDir + "/" + fileNameFor(level, locale, voiceName);
+        QString error;
+        if (!write(path, engineName, voiceName, locale, format, clips, &error)) {
+            qCritical().noquote() << error;
+            return false;
+        }
+        qInfo().noquote() << QString("audio pack level %1 %2: %3 utterances in %4 s with %5 engines (%6 utterances/s), %7 failed -> %8 (%9 MB)")
+            .arg(level, locale.name())
+            .arg(clips.size())
+            .arg(seconds, 0, 'f', 1)
+            .arg(jobs)
+            .arg(seconds > 0 ? texts.size() / seconds : 0.0, 0, 'f', 1)
+            .arg(failed)
+            .arg(path)
+            .arg(QFileInfo(path).size() / 1048576.0, 0, 'f', 1);
+    }
+    return true;
+}
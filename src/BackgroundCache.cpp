@@ -0,0 +1,162 @@
+#include "BackgroundCache.h"
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QPalette>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+
+namespace {
+// Labels waiting for a variant that is being composited, keyed by cache key.
+// Only touched on the GUI thread.
+QHash<QString, QList<QPointer<QLabel>>>& pendingLabels()
+{
+    static QHash<QString, QList<QPointer<QLabel>>> pending;
+    return pending;
+}
+
+QSet<QString>& inFlightKeys()
+{
+    static QSet<QString> keys;
+    return keys;
+}
+
+// With baked assets, faded variants composited here are flattened onto the
+// same window colour as tools/AssetBaker, so both kinds look the same.
+#ifdef ELA_WINDOW_COLOR
+const QImage::Format kFadedFormat = QImage::Format_RGB32;
+const QColor kFadeBase = QColor(QRgb(ELA_WINDOW_COLOR));
+#else
+const QImage::Format kFadedFormat = QImage::Format_ARGB32_Premultiplied;
+const QColor kFadeBase = Qt::transparent;
+#endif
+}
+
+QString BackgroundCache::cacheKey(qreal opacity, const QSize& size, qreal dpr)
+{
+    return QString("background:%1:%2x%3@%4").arg(opacity).arg(size.width()).arg(size.height()).arg(dpr);
+}
+
+QString BackgroundCache::bakedPath(qreal opacity, const QSize& size, qreal dpr)
+{
+    return QString(":/backgrounds/background_%1x%2_o%3@%4x.jpg")
+        .arg(size.width()).arg(size.height()).arg(qRound(opacity * 100)).arg(qRound(dpr));
+}
+
+QImage BackgroundCache::compose(qreal opacity, const QSize& size, qreal dpr)
+{
+    ELA_TRACE_SCOPE("BackgroundCache::compose");
+    // Variants baked at build time are already the right size and already
+    // flattened onto the window colour; only odd scale factors fall through.
+    if (qFuzzyCompare(dpr, qreal(qRound(dpr)))) {
+        QImage baked(bakedPath(opacity, size, dpr));
+        if (!baked.isNull()) {
+            baked.setDevicePixelRatio(dpr);
+            return baked;
+        }
+    }
+
+    static QMutex mutex;
+    static QImage source;
+
+    QImage image;
+    {
+        QMutexLocker locker(&mutex);
+        if (source.isNull()) {
+            // With baked assets the original is not shipped; the largest
+            // opaque variant is the best remaining source.
+            source = QImage(":/Learn-English.png");
+            if (source.isNull()) {
+                source = QImage(bakedPath(1.0, QSize(600, 400), 2.0));
+            }
+        }
+        image = source;
+    }
+
+    // Scaling first means the fade only touches the window-sized image.
+    QImage scaled = image.scaled(size * dpr, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    if (opacity < 1.0) {
+        QImage faded(scaled.size(), kFadedFormat);
+        faded.fill(kFadeBase);
+        QPainter painter(&faded);
+        painter.setOpacity(opacity);
+        painter.drawImage(0, 0, scaled);
+        painter.end();
+        scaled = faded;
+    }
+    scaled.setDevicePixelRatio(dpr);
+    return scaled;
+}
+
+QPixmap BackgroundCache::pixmap(qreal opacity, const QSize& size, qreal dpr)
+{
+    QString key = cacheKey(opacity, size, dpr);
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        pixmap = QPixmap::fromImage(compose(opacity, size, dpr));
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
+}
+
+void BackgroundCache::applyTo(QLabel* label, qreal opacity, const QSize& size)
+{
+#ifdef ELA_WINDOW_COLOR
+    // Only the background itself is pinned to the baked colour; the rest of
+    // the app keeps the system palette.
+    QPalette palette = label->palette();
+    palette.setColor(QPalette::Window, kFadeBase);
+    label->setPalette(palette);
+    label->setAutoFillBackground(true);
+#endif
+
+    qreal dpr = label->devicePixelRatioF();
+    QString key = cacheKey(opacity, size, dpr);
+
+    QPixmap cached;
+    if (QPixmapCache::find(key, &cached)) {
+        label->setPixmap(cached);
+        return;
+    }
+
+    QPixmap placeholder(size);
+    placeholder.fill(kFadeBase);
+    label->setPixmap(placeholder);
+
+    pendingLabels()[key].append(label);
+    preload(opacity, size, dpr);
+}
+
+void BackgroundCache::preload(qreal opacity, const QSize& size, qreal dpr)
+{
+    QString key = cacheKey(opacity, size, dpr);
+    QPixmap cached;
+    if (QPixmapCache::find(key, &cached)) {
+        return;
+    }
+
+    // The first request for a key starts the worker; later ones only wait.
+    if (inFlightKeys().contains(key)) {
+        return;
+    }
+    inFlightKeys().insert(key);
+
+    QThreadPool::globalInstance()->start([opacity, size, dpr, key]() {
+        QImage image = compose(opacity, size, dpr);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [key, image]() {
+            QPixmap pixmap = QPixmap::fromImage(image);
+            QPixmapCache::insert(key, pixmap);
+            inFlightKeys().remove(key);
+            const QList<QPointer<QLabel>> labels = pendingLabels().take(key);
+            for (const QPointer<QLabel>& label : labels) {
+                if (label) {
+                    label->setPixmap(pixmap);
+                }
+            }
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,213 @@
+#include "CardItem.h"
+#include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+#include <QTextOption>
+
+namespace {
+// Cards are painted here rather than styled, so this is their only palette.
+const QColor kCardColor("#f1c70c");
+const QColor kHoverColor("#f5d33f");
+const QColor kSelectedColor("#ffe066");
+const QColor kMismatchColor(Qt::red);
+const qreal kRadius = 8;
+const qreal kPadding = 6;
+
+QFont cardFont()
+{
+    QFont font;
+    font.setPixelSize(16);
+    font.setBold(true);
+    return font;
+}
+}
+
+CardItem::CardItem(const QString& word, const QSizeF& size, QGraphicsItem* parent)
+    : QGraphicsObject(parent)
+    , cardSize(size)
+    , motion(new QPropertyAnimation(this, "pos", this))
+    , fade(new QPropertyAnimation(this, "opacity", this))
+{
+    QTextOption option;
+    option.setAlignment(Qt::AlignCenter);
+    option.setWrapMode(QTextOption::WordWrap);
+    label.setTextOption(option);
+    label.setTextWidth(size.width() - 2 * kPadding);
+    label.setPerformanceHint(QStaticText::AggressiveCaching);
+    setWord(word);
+
+    setAcceptHoverEvents(true);
+    setAcceptedMouseButtons(Qt::LeftButton);
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
+    // Only vanish() runs the fade, and stop() does not emit finished(), so
+    // this fires only for a card that really left the board.
+    connect(fade, &QPropertyAnimation::finished, this, [this]() {
+        hide();
+        setOpacity(1.0);
+        setPos(homePos);
+    });
+    for (QPropertyAnimation* animation : { motion, fade }) {
+        connect(animation, &QAbstractAnimation::stateChanged, this,
+                [this](QAbstractAnimation::State newState, QAbstractAnimation::State oldState) {
+            if (newState == QAbstractAnimation::Running || oldState == QAbstractAnimation::Running) {
+                emit animationRunningChanged(newState == QAbstractAnimation::Running);
+            }
+        });
+    }
+}
+
+void CardItem::setWord(const QString& word)
+{
+    text = word;
+    label.setText(word);
+    label.prepare(QTransform(), cardFont());
+}
+
+void CardItem::reset(const QString& word)
+{
+    retire();
+    if (word != text) {
+        setWord(word);
+    }
+    cardState = Normal;
+    hovered = false;
+    pressed = false;
+    setOpacity(1.0);
+    setEnabled(true);
+    show();
+    update();
+}
+
+void CardItem::retire()
+{
+    motion->stop();
+    fade->stop();
+    hide();
+}
+
+QString CardItem::word() const
+{
+    return text;
+}
+
+CardItem::State CardItem::state() const
+{
+    return cardState;
+}
+
+void CardItem::setState(State state)
+{
+    if (state != cardState) {
+        cardState = state;
+        update();
+    }
+}
+
+QPointF CardItem::home() const
+{
+    return homePos;
+}
+
+void CardItem::setHome(const QPointF& home)
+{
+    homePos = home;
+    setPos(home);
+}
+
+void CardItem::bounce(const QPointF& offset, int duration, int loops)
+{
+    motion->stop();
+    motion->setKeyValues(QVariantAnimation::KeyValues());
+    motion->setDuration(duration);
+    motion->setStartValue(homePos);
+    motion->setKeyValueAt(0.5, homePos + offset);
+    motion->setEndValue(homePos);
+    motion->setEasingCurve(QEasingCurve::InOutQuad);
+    motion->setLoopCount(loops);
+    motion->start();
+}
+
+void CardItem::vanish(const QPointF& offset, int duration)
+{
+    motion->stop();
+    motion->setKeyValues(QVariantAnimation::KeyValues());
+    motion->setDuration(duration);
+    motion->setStartValue(homePos);
+    motion->setEndValue(homePos + offset);
+    motion->setEasingCurve(QEasingCurve::OutCubic);
+    motion->setLoopCount(1);
+    motion->start();
+
+    fade->stop();
+    fade->setDuration(duration);
+    fade->setStartValue(1.0);
+    fade->setEndValue(0.0);
+    fade->start();
+}
+
+QRectF CardItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), cardSize);
+}
+
+void CardItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*)
+{
+    QColor color = kCardColor;
+    if (cardState == Selected) {
+        color = kSelectedColor;
+    } else if (cardState == Mismatch) {
+        color = kMismatchColor;
+    }
+    if (hovered || pressed) {
+        color = kHoverColor;
+    }
+
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(color);
+    painter->drawRoundedRect(boundingRect(), kRadius, kRadius);
+
+    painter->setPen(Qt::black);
+    painter->setFont(cardFont());
+    QSizeF textSize = label.size();
+    painter->drawStaticText(QPointF(kPadding, (cardSize.height() - textSize.height()) / 2), label);
+}
+
+void CardItem::mousePressEvent(QGraphicsSceneMouseEvent* event)
+{
+    pressed = true;
+    update();
+    event->accept();
+}
+
+void CardItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
+{
+    pressed = false;
+    update();
+    if (boundingRect().contains(event->pos())) {
+        emit clicked();
+    }
+}
+
+void CardItem::hoverEnterEvent(QGraphicsSceneHoverEvent*)
+{
+    hovered = true;
+    update();
+}
+
+void CardItem::hoverLeaveEvent(QGraphicsSceneHoverEvent*)
+{
+    hovered = false;
+    update();
+}
+
+QVariant CardItem::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    // A disabled card gets no leave event, so drop the hover look here.
+    if (change == ItemEnabledHasChanged && !value.toBool()) {
+        hovered = false;
+        pressed = false;
+        update();
+    }
+    return QGraphicsObject::itemChange(change, value);
+}
@@ -0,0 +1,190 @@
+#include "ConfusionMatrix.h"
+#include "Trace.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const quint32 kConfusionMagic = 0x454C4143; // "ELAC"
+const quint16 kConfusionVersion = 2;
+const QString kAllUsers;
+}
+
+ConfusionMatrix& ConfusionMatrix::instance()
+{
+    static ConfusionMatrix matrix;
+    return matrix;
+}
+
+ConfusionMatrix::ConfusionMatrix()
+    : generation(0)
+{
+    ELA_TRACE_SCOPE("ConfusionMatrix load");
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    path = dir + "/confusions.dat";
+    journal.setFileName(dir + "/confusions.journal");
+
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_6_0);
+        quint32 magic = 0;
+        quint16 version = 0;
+        in >> magic >> version;
+        if (magic == kConfusionMagic && version == kConfusionVersion) {
+            in >> generation >> matrices;
+        } else if (magic == kConfusionMagic && version == 1) {
+            in >> matrices;
+        }
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Corrupt confusion data, starting over:" << path;
+            generation = 0;
+            matrices.clear();
+        }
+    }
+
+    replayJournal();
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Could not open confusion journal:" << journal.fileName();
+    }
+}
+
+ConfusionMatrix::~ConfusionMatrix()
+{
+    if (journal.size() > 0) {
+        save();
+    }
+}
+
+void ConfusionMatrix::replayJournal()
+{
+    if (!journal.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    // A record torn by a crash ends the replay.
+    QDataStream in(&journal);
+    in.setVersion(QDataStream::Qt_6_0);
+    while (!in.atEnd()) {
+        quint64 recordGeneration = 0;
+        QString user, expected, given;
+        in >> recordGeneration >> user >> expected >> given;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        if (recordGeneration == generation) {
+            matrices[user][expected][given]++;
+            matrices[kAllUsers][expected][given]++;
+        }
+    }
+    journal.close();
+}
+
+void ConfusionMatrix::record(const QString& user, const QString& expected, const QString& given)
+{
+    if (expected.isEmpty() || given.isEmpty() || expected == given) {
+        return;
+    }
+    matrices[user][expected][given]++;
+    matrices[kAllUsers][expected][given]++;
+
+    if (!journal.isOpen()) {
+        save();
+        return;
+    }
+    QDataStream out(&journal);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << generation << user << expected << given;
+    journal.flush();
+    if (journal.size() > kJournalLimit) {
+        save();
+    }
+}
+
+void ConfusionMatrix::removeUser(const QString& user)
+{
+    const Matrix removed = matrices.take(user);
+    Matrix& all = matrices[kAllUsers];
+    for (auto row = removed.constBegin(); row != removed.constEnd(); ++row) {
+        auto allRow = all.find(row.key());
+        if (allRow == all.end()) {
+            continue;
+        }
+        for (auto cell = row->constBegin(); cell != row->constEnd(); ++cell) {
+            auto allCell = allRow->find(cell.key());
+            if (allCell == allRow->end()) {
+                continue;
+            }
+            *allCell -= cell.value();
+            if (*allCell <= 0) {
+                allRow->erase(allCell);
+            }
+        }
+        // An empty row would still be listed by confusedWords().
+        if (allRow->isEmpty()) {
+            all.erase(allRow);
+        }
+    }
+    save();
+}
+
+QList<ConfusionMatrix::Pair> ConfusionMatrix::mostConfused(const QString& user, int count) const
+{
+    QList<Pair> pairs;
+    const Matrix matrix = matrices.value(user);
+    for (auto row = matrix.constBegin(); row != matrix.constEnd(); ++row) {
+        for (auto cell = row->constBegin(); cell != row->constEnd(); ++cell) {
+            pairs.append({ row.key(), cell.key(), cell.value() });
+        }
+    }
+
+    auto byCount = [](const Pair& a, const Pair& b) { return a.count > b.count; };
+    int n = qMin(count, int(pairs.size()));
+    std::partial_sort(pairs.begin(), pairs.begin() + n, pairs.end(), byCount);
+    pairs.resize(n);
+    return pairs;
+}
+
+QStringList ConfusionMatrix::confusablesFor(const QString& user, const QString& word) const
+{
+    const QHash<QString, int> row = matrices.value(user).value(word);
+    QStringList result = row.keys();
+    std::sort(result.begin(), result.end(), [&row](const QString& a, const QString& b) {
+        return row.value(a) > row.value(b);
+    });
+    return result;
+}
+
+QStringList ConfusionMatrix::confusedWords(const QString& user) const
+{
+    return matrices.value(user).keys();
+}
+
+void ConfusionMatrix::save()
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write confusion data:" << path;
+        return;
+    }
+    quint64 next = QRandomGenerator::global()->generate64();
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kConfusionMagic << kConfusionVersion << next << matrices;
+    if (!file.commit()) {
+        qWarning() << "Could not write confusion data:" << path;
+        return;
+    }
+
+    // Only now that the snapshot holds them can the records be dropped.
+    generation = next;
+    journal.close();
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not open confusion journal:" << journal.fileName();
+    }
+}
@@ -0,0 +1,171 @@
+#include "FrameMonitor.h"
+#include <QtGlobal>
+
+namespace {
+bool& instrumentation()
+{
+    static bool enabled = qEnvironmentVariableIntValue("ELA_FRAME_STATS") != 0;
+    return enabled;
+}
+
+QString ms(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 2);
+}
+}
+
+void FrameHistogram::add(qint64 ns)
+{
+    int bucket = int(qMin<qint64>(ns / kBucketNs, kBuckets));
+    ++buckets[bucket];
+    ++samples;
+    total += ns;
+    largest = qMax(largest, ns);
+}
+
+void FrameHistogram::clear()
+{
+    buckets.fill(0);
+    samples = 0;
+    total = 0;
+    largest = 0;
+}
+
+int FrameHistogram::count() const
+{
+    return samples;
+}
+
+qint64 FrameHistogram::max() const
+{
+    return largest;
+}
+
+qint64 FrameHistogram::mean() const
+{
+    return samples > 0 ? total / samples : 0;
+}
+
+qint64 FrameHistogram::percentile(double fraction) const
+{
+    if (samples == 0) {
+        return 0;
+    }
+    qint64 rank = qMax<qint64>(1, qint64(fraction * samples + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return qMin((i + 1) * kBucketNs, largest);
+        }
+    }
+    return largest;
+}
+
+FrameMonitor::FrameMonitor(const QString& name)
+    : name(name)
+    , enabled(instrumentationEnabled())
+{
+    clock.start();
+}
+
+bool FrameMonitor::instrumentationEnabled()
+{
+    return instrumentation();
+}
+
+void FrameMonitor::setInstrumentationEnabled(bool enabled)
+{
+    instrumentation() = enabled;
+}
+
+void FrameMonitor::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+    lastFrameNs = -1;
+}
+
+bool FrameMonitor::isEnabled() const
+{
+    return enabled;
+}
+
+void FrameMonitor::setRefreshRate(qreal hz)
+{
+    if (hz > 0) {
+        frameNs = 1e9 / hz;
+    }
+}
+
+void FrameMonitor::beginBurst()
+{
+    animating = true;
+    lastFrameNs = -1;
+    if (enabled) {
+        ++bursts;
+    }
+}
+
+void FrameMonitor::endBurst()
+{
+    animating = false;
+    lastFrameNs = -1;
+}
+
+bool FrameMonitor::isRecording() const
+{
+    return enabled && animating;
+}
+
+qint64 FrameMonitor::now() const
+{
+    return clock.nsecsElapsed();
+}
+
+void FrameMonitor::framePainted(qint64 startNs, qint64 costNs)
+{
+    paintCosts.add(costNs);
+    if (lastFrameNs >= 0) {
+        qint64 interval = startNs - lastFrameNs;
+        intervals.add(interval);
+        // A frame counts as dropped once a paint is half a refresh late.
+        if (interval > frameNs * 1.5) {
+            dropped += qRound(interval / frameNs) - 1;
+        }
+    }
+    lastFrameNs = startNs;
+}
+
+int FrameMonitor::frames() const
+{
+    return paintCosts.count();
+}
+
+int FrameMonitor::droppedFrames() const
+{
+    return dropped;
+}
+
+QString FrameMonitor::summary() const
+{
+    if (intervals.count() == 0) {
+        return QString("%1: no animated frames recorded").arg(name);
+    }
+    return QString("%1: %2 frames in %3 bursts, interval p50 %4 p95 %5 p99 %6 max %7 ms, "
+                   "%8 dropped at %9 Hz, paint p50 %10 p95 %11 max %12 ms")
+        .arg(name)
+        .arg(frames()).arg(bursts)
+        .arg(ms(intervals.percentile(0.50)), ms(intervals.percentile(0.95)),
+             ms(intervals.percentile(0.99)), ms(intervals.max()))
+        .arg(dropped).arg(1e9 / frameNs, 0, 'f', 0)
+        .arg(ms(paintCosts.percentile(0.50)), ms(paintCosts.percentile(0.95)), ms(paintCosts.max()));
+}
+
+void FrameMonitor::clear()
+{
+    intervals.clear();
+    paintCosts.clear();
+    bursts = animating ? 1 : 0;
+    dropped = 0;
+    lastFrameNs = -1;
+}
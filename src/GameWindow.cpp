@@ -1,4 +1,13 @@
 #include "GameWindow.h"
+#include "AnswerText.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
+#include "ProgressLog.h"
+#include "ProgressSync.h"
+#include "ConfusionMatrix.h"
+#include "SoundBank.h"
+#include "SpeechService.h"
+#include "Trace.h"
 #include <QJsonDocument>
 #include <QFile>
 #include <QMessageBox>
@@ -7,24 +16,25 @@
 #include <QHBoxLayout>
 #include <QButtonGroup>
 #include <QFontDatabase>
-#include <QRegularExpression>
 #include <QGuiApplication>
 #include <QInputMethod>
-#include <QPainter>
-#include <QScreen>
 #include <QRandomGenerator>
+#include <QTimer>
 
-GameWindow::GameWindow(const QString& mode, const QString& level, QWidget* parent)
-    : QMainWindow(parent),
+GameWindow::GameWindow(const QString& mode, QWidget* parent)
+    : QWidget(parent),
+      correctAnswerNode(AnswerTrie::kNoMatch),
+      answerRevealed(false),
       mode(mode),
-      currentLevel(level),
       score(0),
       currentWordCount(0),
-      tts(new QTextToSpeech(this)),
+      userName(SessionCheckpoint::currentUserName()),
+      checkpoint(userName),
       voiceButtonGroup(new QButtonGroup(this)),
       showAnswerButton(new QPushButton("הראה תשובה", this)),
       showExampleButton(new QPushButton("הצג דוגמא", this))
 {
+    ELA_TRACE_SCOPE("GameWindow::GameWindow");
     if (mode == "English") {
         voiceLayout = new QHBoxLayout();
     } else {
@@ -32,61 +42,97 @@ GameWindow::GameWindow(const QString& mode, const QString& level, QWidget* paren
     }
 
     setupUI();
-    loadDictionary(level);
-    setupQuestion();
 
     connect(btnCheck, &QPushButton::clicked, this, &GameWindow::checkAnswer);
     connect(showExampleButton, &QPushButton::clicked, this, &GameWindow::showExample);
     connect(showAnswerButton, &QPushButton::clicked, this, &GameWindow::revealAnswer);
 
-    if (mode == "Hebrew") {
-        tts->setLocale(QLocale(QLocale::Hebrew, QLocale::Israel));
+    // Voice buttons appear once the shared engine has listed its voices.
+    SpeechService& speech = SpeechService::instance();
+    connect(&speech, &SpeechService::ready, this, &GameWindow::updateVoiceButtons);
+    if (speech.isReady()) {
+        updateVoiceButtons();
     } else {
-        tts->setLocale(QLocale(QLocale::English, QLocale::UnitedStates));
+        speech.start();
     }
+}
 
-    QList<QVoice> availableVoices = tts->availableVoices();
-    voices = availableVoices;
+GameWindow::~GameWindow() {}
 
-    updateVoiceButtons();
-    playAudio();
+void GameWindow::start(const QString& level)
+{
+    resetSession(level);
+    setupQuestion();
+    beginCheckpoint();
+    playAudioLater();
 }
 
-GameWindow::~GameWindow() {}
+void GameWindow::resetSession(const QString& level)
+{
+    if (level != currentLevel || dictionary.isEmpty()) {
+        currentLevel = level;
+        loadDictionary(level);
+    }
 
-void GameWindow::setupUI()
+    score = 0;
+    currentWordCount = 0;
+    answeredKeys.clear();
+    pendingReview.clear();
+    currentKey.clear();
+    upcomingKey.clear();
+    labelScore->setText("Score: 0");
+    lineEditAnswer->clear();
+    labelFeedback->clear();
+}
+
+void GameWindow::restoreSession(const SessionState& state)
 {
-    setWindowTitle("Translation Game");
+    resetSession(state.level);
+    score = state.score;
+    currentWordCount = state.currentWordCount;
+    answeredKeys = QSet<QString>(state.answered.begin(), state.answered.end());
+    labelScore->setText(QString("ניקוד: %1").arg(score));
+
+    if (dictionary.contains(state.currentKey) && !answeredKeys.contains(state.currentKey)) {
+        showQuestion(state.currentKey);
+    } else {
+        setupQuestion();
+    }
 
-    QIcon windowIcon(":/Learn-English-Icon.png");
-    setWindowIcon(windowIcon);
+    beginCheckpoint();
+    playAudioLater();
+}
 
-    QWidget* centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
+void GameWindow::beginCheckpoint()
+{
+    SessionState state;
+    state.gameMode = mode;
+    state.level = currentLevel;
+    state.score = score;
+    state.currentWordCount = currentWordCount;
+    state.currentKey = currentKey;
+    state.answered = QStringList(answeredKeys.begin(), answeredKeys.end());
+    checkpoint.begin(state);
+}
+
+void GameWindow::setupUI()
+{
+    setWindowTitle("Translation Game");
 
-    QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(0, 0, 0, 0);
 
-    QLabel* imageLabel = new QLabel(centralWidget);
+    QLabel* imageLabel = new QLabel(this);
     imageLabel->setScaledContents(true);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-    QPixmap pixmap(":/Learn-English.png");
-    QImage image = pixmap.toImage();
-    QImage transparentImage(image.size(), QImage::Format_ARGB32);
-    transparentImage.fill(Qt::transparent);
-    QPainter painter(&transparentImage);
-    painter.setOpacity(0.3);
-    painter.drawImage(0, 0, image);
-    painter.end();
-    QPixmap transparentPixmap = QPixmap::fromImage(transparentImage);
-    imageLabel->setPixmap(transparentPixmap.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    BackgroundCache::applyTo(imageLabel, 0.3, QSize(600, 400));
     imageLabel->setFixedSize(600, 400);
     imageLabel->setGeometry(0, 0, 600, 400);
     imageLabel->lower();
 
-    QWidget* contentWidget = new QWidget(centralWidget);
-    contentWidget->setStyleSheet("background: transparent;");
+    QWidget* contentWidget = new QWidget(this);
+    AppStyle::setRole(contentWidget, "content");
     QVBoxLayout* contentLayout = new QVBoxLayout(contentWidget);
 
     QFont labelFont("Arial", 14, QFont::Bold);
@@ -94,60 +140,40 @@ void GameWindow::setupUI()
 
     labelQuestion = new QLabel(this);
     labelQuestion->setFont(labelFont);
-    labelQuestion->setStyleSheet("color: black;");
+    AppStyle::setRole(labelQuestion, "question");
     labelQuestion->setAlignment(Qt::AlignCenter);
+    labelQuestion->setMinimumWidth(200);
+    labelQuestion->setMinimumHeight(60);
 
     labelFeedback = new QLabel(this);
     labelFeedback->setFont(labelFont);
-    labelFeedback->setStyleSheet("color: black;");
+    AppStyle::setRole(labelFeedback, "feedback");
 
     labelScore = new QLabel("Score: 0", this);
     labelScore->setFont(labelFont);
-    labelFeedback->setStyleSheet("color: black;");
+    AppStyle::setRole(labelScore, "score");
 
     lineEditAnswer = new QLineEdit(this);
     lineEditAnswer->setFont(labelFont);
-    lineEditAnswer->setStyleSheet(
-        "QLineEdit {"
-        "   background-color: rgba(255, 255, 255, 0.8);"
-        "   color: black;"
-        "   border: 1px solid white;"
-        "   padding: 10px;"
-        "}");
-
-    QString buttonStyle =
-        "QPushButton {"
-        "   background-color: #f1c70c;"
-        "   color: black;"
-        "   font-size: 16px;"
-        "   padding: 10px;"
-        "   border-radius: 8px;"
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f5d33f;"
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #f5d33f;"
-        "}";
+    AppStyle::setRole(lineEditAnswer, "answer");
 
     btnAudio = new QPushButton("🔊 השמע שוב", this);
     btnAudio->setFont(buttonFont);
-    btnAudio->setStyleSheet(buttonStyle);
+    AppStyle::setRole(btnAudio, "action");
 
     btnCheck = new QPushButton("בדוק תשובה", this);
     btnCheck->setFont(buttonFont);
-    btnCheck->setStyleSheet(buttonStyle);
+    AppStyle::setRole(btnCheck, "action");
 
     btnClose = new QPushButton("סגור", this);
     btnClose->setFont(buttonFont);
-    btnClose->setStyleSheet(buttonStyle);
+    AppStyle::setRole(btnClose, "action");
 
     showAnswerButton->setFont(buttonFont);
-    showAnswerButton->setStyleSheet(buttonStyle);
+    AppStyle::setRole(showAnswerButton, "action");
 
     showExampleButton->setFont(buttonFont);
-    showExampleButton->setStyleSheet(buttonStyle);
+    AppStyle::setRole(showExampleButton, "action");
 
     contentLayout->addWidget(labelQuestion);
 
@@ -156,6 +182,9 @@ void GameWindow::setupUI()
     frame->setLineWidth(2);
     QVBoxLayout* frameLayout = new QVBoxLayout(frame);
     frameLayout->addWidget(lineEditAnswer);
+    liveCheckBox = new QCheckBox("בדוק תוך כדי הקלדה", this);
+    liveCheckBox->setChecked(ProgressSync::registerValue("liveAnswerCheck", false).toBool());
+    frameLayout->addWidget(liveCheckBox);
     frameLayout->setContentsMargins(5, 5, 5, 5);
     contentLayout->addWidget(frame);
 
@@ -174,20 +203,14 @@ void GameWindow::setupUI()
 
     mainLayout->addWidget(contentWidget);
 
-    resize(600, 400);
-
-    QScreen* screen = QGuiApplication::primaryScreen();
-    if (screen) {
-        QRect screenGeometry = screen->geometry();
-        int x = (screenGeometry.width() - this->width()) / 2;
-        int y = (screenGeometry.height() - this->height()) / 2;
-        this->move(x, y);
-    }
-
     connect(btnAudio, &QPushButton::clicked, this, &GameWindow::playAudio);
-    connect(btnClose, &QPushButton::clicked, this, &GameWindow::close);
+    connect(btnClose, &QPushButton::clicked, this, &GameWindow::goBack);
     connect(lineEditAnswer, &QLineEdit::textChanged, this, &GameWindow::checkKeyboardLanguage);
-    connect(showAnswerButton, &QPushButton::clicked, this, &GameWindow::revealAnswer);
+    connect(lineEditAnswer, &QLineEdit::textChanged, this, &GameWindow::updateLiveFeedback);
+    connect(liveCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        ProgressSync::setRegister("liveAnswerCheck", checked);
+        updateLiveFeedback();
+    });
 }
 
 void GameWindow::updateVoiceButtons()
@@ -206,7 +229,7 @@ void GameWindow::updateVoiceButtons()
     voiceButtonGroup->setExclusive(true);
 
     QList<QVoice> filteredVoices;
-    for (const QVoice& voice : voices) {
+    for (const QVoice& voice : SpeechService::instance().voices(speechLocale())) {
         if (mode == "Hebrew") {
             if (voice.locale().language() == QLocale::Hebrew && voice.name().contains("Asaf")) {
                 filteredVoices.append(voice);
@@ -219,37 +242,22 @@ void GameWindow::updateVoiceButtons()
         }
     }
 
-    if (filteredVoices.isEmpty()) {
-        qWarning() << "No voices available for the selected language.";
-        QMessageBox::warning(this, "Voice Error", "אין קולות זמינים עבור השפה שנבחרה.");
+    voices = filteredVoices;
+    currentVoice = QVoice();
+    if (voices.isEmpty()) {
+        // Other platforms name their voices differently; the engine's
+        // default voice for the language is used instead.
+        qDebug() << "No preferred voice for" << speechLocale().name() << "- using the default voice.";
         return;
     }
 
-    voices = filteredVoices;
-
-    QString voiceButtonStyle =
-        "QPushButton {"
-        "   background-color: #f1c70c;"
-        "   color: black;"
-        "   font-size: 14px;"
-        "   padding: 8px;"
-        "   border-radius: 8px;"
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f5d33f;"
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #f5d33f;"
-        "}";
-
     if (mode != "Hebrew") {
         for (int i = 0; i < voices.size(); ++i) {
             QString voiceName = voices[i].name();
             QString icon = (voiceName.contains("David") || voiceName.contains("Mark")) ? "👨" : "👩";
             voiceName.replace("Microsoft ", "");
             QPushButton* btnVoice = new QPushButton(icon + " " + voiceName, this);
-            btnVoice->setStyleSheet(voiceButtonStyle);
+            AppStyle::setRole(btnVoice, "voice");
             btnVoice->setCheckable(true);
             voiceButtonGroup->addButton(btnVoice, i);
             voiceLayout->addWidget(btnVoice);
@@ -275,11 +283,9 @@ void GameWindow::revealAnswer()
         QString("התשובה היא: %1").arg(correctAnswer);
 
     labelFeedback->setText(answerText);
-    labelFeedback->setStyleSheet(
-        "color: black;"
-        "font-weight: bold;"
-        "font-size: 18px;"
-    );
+    AppStyle::setState(labelFeedback, "feedback", "answer");
+    // A revealed answer is not the learner's, so live checking must not submit it.
+    answerRevealed = true;
     lineEditAnswer->setText(correctAnswer);
     showAnswerButton->setEnabled(false);
 }
@@ -299,42 +305,48 @@ void GameWindow::showExample()
         }
 
         labelFeedback->setText(exampleText);
-        labelFeedback->setStyleSheet(
-            "color: black;"
-            "font-weight: bold;"
-            "font-size: 16px;"
-        );
+        AppStyle::setState(labelFeedback, "feedback", "example");
+        SpeechService::instance().speak(examples.first, QLocale(QLocale::English, QLocale::UnitedStates),
+                                        mode == "English" ? currentVoice : QVoice(), SpeechService::Example);
     } else {
         labelFeedback->setText("אין דוגמא זמינה.");
-        labelFeedback->setStyleSheet(
-            "color: black;"
-            "font-weight: bold;"
-            "font-size: 16px;"
-        );
+        AppStyle::setState(labelFeedback, "feedback", "example");
     }
 }
 
 void GameWindow::selectVoice(int voiceIndex)
 {
     if (voiceIndex >= 0 && voiceIndex < voices.size()) {
-        tts->setVoice(voices[voiceIndex]);
+        currentVoice = voices[voiceIndex];
         qDebug() << "בחירת קול:" << voices[voiceIndex].name()
                  << "שפה:" << voices[voiceIndex].locale().name();
     }
 }
 
-void GameWindow::playAudio()
+QLocale GameWindow::speechLocale() const
 {
-    if (voices.isEmpty()) {
-        qWarning() << "אין קולות זמינים.";
-        return;
-    }
+    return mode == "Hebrew" ? QLocale(QLocale::Hebrew, QLocale::Israel)
+                            : QLocale(QLocale::English, QLocale::UnitedStates);
+}
+
+void GameWindow::playAudioLater()
+{
+    // Lets the page paint before speech starts.
+    QTimer::singleShot(0, this, [this]() {
+        if (isVisible()) {
+            playAudio();
+        }
+    });
+}
 
-    QString textToSpeak = currentQuestion;
-    tts->say(textToSpeak);
+void GameWindow::playAudio()
+{
+    SpeechService::instance().speak(currentQuestion, speechLocale(), currentVoice);
+    prefetchNext();
 }
 
 void GameWindow::loadDictionary(const QString& level) {
+    ELA_TRACE_SCOPE("GameWindow::loadDictionary");
     QString filePath = QString("resources/%1").arg(level);
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -347,22 +359,28 @@ void GameWindow::loadDictionary(const QString& level) {
     QJsonDocument doc = QJsonDocument::fromJson(data);
     dictionary.clear();
     examplesMap.clear();
+    answerToKey.clear();
+    answerTrie.clear();
 
     if (doc.isObject()) {
         QJsonObject jsonObject = doc.object();
         for (auto it = jsonObject.begin(); it != jsonObject.end(); ++it) {
             QString englishWord = it.key();
             QJsonObject wordObj = it.value().toObject();
-            QString hebrewWord = removeHebrewDiacritics(wordObj["translation"].toString());
+            QString hebrewWord = AnswerText::removeHebrewDiacritics(wordObj["translation"].toString());
             QString exampleEn = wordObj["ex_en"].toString();
             QString exampleHe = wordObj["ex_he"].toString();
 
             if (mode == "Hebrew") {
                 dictionary.insert(hebrewWord, englishWord);
                 examplesMap.insert(hebrewWord, qMakePair(exampleEn, exampleHe));
+                answerToKey.insert(normalizeAnswer(englishWord), hebrewWord);
+                answerTrie.insert(normalizeAnswer(englishWord));
             } else {
                 dictionary.insert(englishWord, hebrewWord);
                 examplesMap.insert(englishWord, qMakePair(exampleEn, exampleHe));
+                answerToKey.insert(normalizeAnswer(hebrewWord), englishWord);
+                answerTrie.insert(normalizeAnswer(hebrewWord));
             }
         }
     }
@@ -373,18 +391,78 @@ void GameWindow::loadDictionary(const QString& level) {
 
 void GameWindow::setupQuestion()
 {
-    showAnswerButton->setEnabled(true);
-    showExampleButton->setEnabled(true);
-    QStringList keys = dictionary.keys();
-
-    if (keys.isEmpty()) {
+    if (dictionary.isEmpty()) {
         labelQuestion->setText("אין שאלות זמינות");
         return;
     }
 
-    int randomIndex = QRandomGenerator::global()->bounded(keys.size());
-    currentKey = keys.at(randomIndex);
-    
+    // The next question was picked, and its audio prefetched, while the
+    // learner was answering; only a session change makes it stale.
+    QString key = upcomingKey;
+    if (key.isEmpty() || !dictionary.contains(key) || answeredKeys.contains(key)) {
+        key = chooseKey(currentKey);
+    }
+    pendingReview.removeAll(key);
+    upcomingKey.clear();
+    showQuestion(key);
+}
+
+QString GameWindow::chooseKey(const QString& skip)
+{
+    QStringList keys = dictionary.keys();
+    QStringList remaining;
+    for (const QString& key : keys) {
+        if (!answeredKeys.contains(key) && key != skip) {
+            remaining.append(key);
+        }
+    }
+    if (remaining.isEmpty()) {
+        remaining = keys;
+    }
+
+    // Words the learner just mixed up come back first, and now and then a
+    // word from their confusion history is asked again.
+    for (const QString& key : pendingReview) {
+        if (key != skip && remaining.contains(key)) {
+            return key;
+        }
+    }
+    if (QRandomGenerator::global()->bounded(4) == 0) {
+        QStringList confusable;
+        const QStringList words = ConfusionMatrix::instance().confusedWords(userName);
+        for (const QString& word : words) {
+            QString key = keyForHeadword(word);
+            if (remaining.contains(key)) {
+                confusable.append(key);
+            }
+        }
+        if (!confusable.isEmpty()) {
+            return confusable.at(QRandomGenerator::global()->bounded(confusable.size()));
+        }
+    }
+
+    return remaining.at(QRandomGenerator::global()->bounded(remaining.size()));
+}
+
+void GameWindow::prefetchNext()
+{
+    // Picked once per question, so replaying the word keeps the same pick
+    // and does not start synthesizing another one.
+    if (upcomingKey.isEmpty() || upcomingKey == currentKey || answeredKeys.contains(upcomingKey)) {
+        upcomingKey = chooseKey(currentKey);
+    }
+    // The question text is what playAudio() will say; prefetching the same
+    // text again is a no-op.
+    SpeechService::instance().prefetch(upcomingKey, speechLocale(), currentVoice);
+}
+
+void GameWindow::showQuestion(const QString& key)
+{
+    showAnswerButton->setEnabled(true);
+    showExampleButton->setEnabled(true);
+    currentKey = key;
+    checkpoint.recordCurrent(currentKey);
+
     if (mode == "Hebrew") {
        
         currentQuestion = currentKey;     
@@ -395,25 +473,26 @@ void GameWindow::setupQuestion()
     }
 
     labelQuestion->setText(currentQuestion);
-    labelQuestion->setStyleSheet(
-        "color: black;"
-        "border: 2px solid white;"
-        "padding: 10px;"
-        "font-size: 26px;"
-        "background-color: rgba(255, 255, 255, 0.3);"
-        "border-radius: 8px;"
-    );
-    labelQuestion->setAlignment(Qt::AlignCenter);
-    labelQuestion->setMinimumWidth(200);
-    labelQuestion->setMinimumHeight(60);
+    correctAnswerNode = answerTrie.find(correctAnswer);
+    answerRevealed = false;
 
     lineEditAnswer->clear();
     labelFeedback->clear();
 }
 
-QString GameWindow::removeHebrewDiacritics(const QString& text) {
-    static QRegularExpression diacriticsRegex(QString::fromUtf8("[\\u0591-\\u05C7\\u05B0-\\u05BC\\u05C1-\\u05C2\\u05C4-\\u05C5\\u05C7]"));
-    return text.normalized(QString::NormalizationForm_D).remove(diacriticsRegex);
+QString GameWindow::normalizeAnswer(const QString& text)
+{
+    return AnswerText::normalize(text);
+}
+
+QString GameWindow::headword(const QString& key) const
+{
+    return mode == "Hebrew" ? dictionary.value(key) : key;
+}
+
+QString GameWindow::keyForHeadword(const QString& word)
+{
+    return mode == "Hebrew" ? answerToKey.value(normalizeAnswer(word)) : word;
 }
 
 void GameWindow::checkAnswer() {
@@ -421,82 +500,90 @@ void GameWindow::checkAnswer() {
     
     if (userAnswer.isEmpty()) {
         labelFeedback->setText("אנא הכנס תרגום");
-        labelFeedback->setStyleSheet(
-            "color: black;"
-            "font-size: 18px;"
-            "font-weight: bold;"
-        );
+        AppStyle::setState(labelFeedback, "feedback", "prompt");
         return;
     }
 
-    QString cleanUserAnswer = removeHebrewDiacritics(userAnswer.toLower());
-    QString cleanCorrectAnswer = removeHebrewDiacritics(correctAnswer.toLower());
+    QString cleanUserAnswer = normalizeAnswer(userAnswer);
+    QString cleanCorrectAnswer = normalizeAnswer(correctAnswer);
+
+    bool isCorrect = (cleanUserAnswer == cleanCorrectAnswer);
+    ProgressLog::record(mode, currentLevel, currentKey, isCorrect);
 
-    if (cleanUserAnswer == cleanCorrectAnswer) {
+    SoundBank::instance().play(isCorrect ? SoundBank::Match : SoundBank::Mismatch);
+    if (isCorrect) {
         labelFeedback->setText("נכון!");
-        labelFeedback->setStyleSheet(
-            "color: black;"
-            "font-weight: bold;"
-            "font-size: 18px;"
-        );
+        AppStyle::setState(labelFeedback, "feedback", "correct");
         score++;
-        labelScore->setText(QString("ניקוד: %1").arg(score));
-        labelScore->setStyleSheet(
-            "font-size: 22px;"
-            "color: black;"
-        );
         currentWordCount++;
+        answeredKeys.insert(currentKey);
+        checkpoint.recordAnswer(currentKey, score, currentWordCount);
+        labelScore->setText(QString("ניקוד: %1").arg(score));
         if (currentWordCount >= dictionary.count()) {
+            checkpoint.clear();
             QString levelText = QString("שלב %1").arg(currentLevel);
             QMessageBox::information(this, "השלב הושלם",
                 QString("כל הכבוד! השלמת את %1!\nניקוד סופי: %2/%3")
                 .arg(levelText)
                 .arg(score)
                 .arg(dictionary.count()));
-            close();
+            goBack();
             return;
         }
         setupQuestion();
         playAudio();
     } else {
+        QString confusedKey = answerToKey.value(cleanUserAnswer);
+        if (!confusedKey.isEmpty() && confusedKey != currentKey) {
+            ConfusionMatrix::instance().record(userName, headword(currentKey), headword(confusedKey));
+            if (!answeredKeys.contains(confusedKey) && !pendingReview.contains(confusedKey)) {
+                pendingReview.append(confusedKey);
+                // The review word may now come first.
+                upcomingKey.clear();
+                prefetchNext();
+            }
+        }
+
         labelFeedback->setText("לא נכון, נסה שוב!");
-        labelFeedback->setStyleSheet(
-            "color: black;"
-            "font-size: 18px;"
-            "font-weight: bold;"
-        );
+        AppStyle::setState(labelFeedback, "feedback", "wrong");
     }
 
     lineEditAnswer->clear();
 }
 
-void GameWindow::close()
+void GameWindow::goBack()
 {
-    if (parentWidget()) {
-        parentWidget()->show();
-    }
-    QMainWindow::close();
-    delete this;
+    checkpoint.clear();
+    SpeechService::instance().stop();
+    emit finished();
 }
 
 void GameWindow::checkKeyboardLanguage()
 {
     QString text = lineEditAnswer->text();
     if (!text.isEmpty()) {
-        QChar lastChar = text.back();
-        bool isHebrew = (lastChar.unicode() >= 0x0590 && lastChar.unicode() <= 0x05FF);
-
-        if ((mode == "Hebrew" && isHebrew) || (mode == "English" && !isHebrew)) {
-            labelFeedback->setText(mode == "Hebrew" ?
-                "נא החלף למקלדת אנגלית" :
-                "נא החלף למקלדת עברית");
-            labelFeedback->setStyleSheet(
-                "color: red;"
-                "font-size: 16px;"
-                "font-weight: bold;"
-            );
+        // Hebrew questions are answered in English and vice versa.
+        QString warning = AnswerText::keyboardWarning(text, mode == "English");
+        if (!warning.isEmpty()) {
+            labelFeedback->setText(warning);
+            AppStyle::setState(labelFeedback, "feedback", "warning");
         } else {
             labelFeedback->clear();
         }
     }
-}
\ No newline at end of file
+}
+
+void GameWindow::updateLiveFeedback()
+{
+    const QString text = lineEditAnswer->text();
+    int node = liveCheckBox->isChecked() ? answerTrie.find(text) : 0;
+    // Red as soon as no answer of the level starts with what was typed.
+    AppStyle::setState(lineEditAnswer, "answer", node == AnswerTrie::kNoMatch ? "dead" : "");
+    if (answerRevealed || node == AnswerTrie::kNoMatch || node != correctAnswerNode || text.trimmed().isEmpty()) {
+        return;
+    }
+    // The trie path matched; checkAnswer() compares the full normal forms.
+    if (normalizeAnswer(text.trimmed()) == normalizeAnswer(correctAnswer)) {
+        checkAnswer();
+    }
+}
@@ -0,0 +1,235 @@
+#include "HeadwordIndex.h"
+#include "AnswerText.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Skeleton symbols of U+05D0-U+05EA after final letters are folded; 0 drops
+// the letter. צ gets a symbol of its own that only "tz" or "ts" produce.
+const char16_t kHebrewSymbols[] = {
+    0,   'b', 'g', 'd', 0,   0,   'z', 'k', 't', 0,   // א ב ג ד ה ו ז ח ט י
+    'k', 'k', 'l', 'm', 'm', 'n', 'n', 's', 0,   'p', // ך כ ל ם מ ן נ ס ע ף
+    'p', 'c', 'c', 'k', 'r', 's', 't'                 // פ ץ צ ק ר ש ת
+};
+
+char16_t latinSymbol(char16_t c)
+{
+    switch (c) {
+    case 'b': case 'v': case 'w':
+        return 'b';
+    case 'g': case 'j':
+        return 'g';
+    case 'k': case 'c': case 'q': case 'x':
+        return 'k';
+    case 'f': case 'p':
+        return 'p';
+    case 'd': case 'l': case 'm': case 'n': case 'r': case 's': case 't': case 'z':
+        return c;
+    default:
+        return 0;   // vowels, h, y, digits and punctuation
+    }
+}
+
+// Two Latin letters written for one Hebrew one, or 0.
+char16_t digraphSymbol(char16_t first, char16_t second)
+{
+    if (second == 'h') {
+        switch (first) {
+        case 's':
+            return 's';
+        case 'c': case 'k':
+            return 'k';
+        case 'p':
+            return 'p';
+        case 't':
+            return 't';
+        case 'z':
+            return 'z';
+        }
+    }
+    if (first == 't' && (second == 'z' || second == 's')) {
+        return 'c';
+    }
+    return 0;
+}
+}
+
+HeadwordIndex::HeadwordIndex()
+    : words(0)
+{
+}
+
+QString HeadwordIndex::skeleton(const QString& text)
+{
+    const QString folded = AnswerText::normalize(text, true);
+    QString out;
+    out.reserve(folded.size());
+    for (qsizetype i = 0; i < folded.size(); ++i) {
+        char16_t c = folded.at(i).unicode();
+        char16_t symbol = 0;
+        if (c >= 0x05D0 && c <= 0x05EA) {
+            symbol = kHebrewSymbols[c - 0x05D0];
+        } else if (c < 0x80) {
+            char16_t next = i + 1 < folded.size() ? folded.at(i + 1).unicode() : 0;
+            symbol = digraphSymbol(c, next);
+            if (symbol) {
+                ++i;
+            } else {
+                symbol = latinSymbol(c);
+            }
+        }
+        if (symbol) {
+            out.append(QChar(symbol));
+        }
+    }
+    return out;
+}
+
+void HeadwordIndex::addWordStarts(QVector<Entry>& entries, const QString& text, int word)
+{
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (!text.at(i).isSpace() && (i == 0 || text.at(i - 1).isSpace())) {
+            entries.append(Entry { text.mid(i), word });
+        }
+    }
+}
+
+void HeadwordIndex::sortEntries(QVector<Entry>& entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.key < b.key || (a.key == b.key && a.word < b.word);
+    });
+}
+
+void HeadwordIndex::build(const QStringList& english, const QStringList& hebrew)
+{
+    englishKeys.clear();
+    hebrewKeys.clear();
+    latinKeys.clear();
+    words = int(english.size());
+    for (int i = 0; i < words; ++i) {
+        addWordStarts(englishKeys, AnswerText::normalize(english.at(i)), i);
+        const QString translation = AnswerText::normalize(hebrew.value(i), true);
+        addWordStarts(hebrewKeys, translation, i);
+        // Each word of the translation on its own, so "erev" finds ארוחת ערב.
+        for (const QString& part : translation.split(' ', Qt::SkipEmptyParts)) {
+            QString key = skeleton(part);
+            if (!key.isEmpty()) {
+                latinKeys.append(Entry { key, i });
+            }
+        }
+    }
+    sortEntries(englishKeys);
+    sortEntries(hebrewKeys);
+    sortEntries(latinKeys);
+}
+
+void HeadwordIndex::collect(const QVector<Entry>& entries, const QString& prefix, int limit, QList<int>& out)
+{
+    auto it = std::lower_bound(entries.begin(), entries.end(), prefix,
+                               [](const Entry& entry, const QString& key) { return entry.key < key; });
+    for (; it != entries.end() && out.size() < limit && it->key.startsWith(prefix); ++it) {
+        if (!out.contains(it->word)) {
+            out.append(it->word);
+        }
+    }
+}
+
+QList<int> HeadwordIndex::find(const QString& query, int limit) const
+{
+    QList<int> found;
+    const QString typed = query.trimmed();
+    if (typed.isEmpty()) {
+        return found;
+    }
+    bool hebrew = std::any_of(typed.begin(), typed.end(), [](QChar c) { return AnswerText::isHebrew(c); });
+    if (hebrew) {
+        collect(hebrewKeys, AnswerText::normalize(typed, true), limit, found);
+        return found;
+    }
+    collect(englishKeys, AnswerText::normalize(typed), limit, found);
+    QString key = skeleton(typed);
+    if (!key.isEmpty()) {
+        collect(latinKeys, key, limit, found);
+    }
+    return found;
+}
+
+int HeadwordIndex::size() const
+{
+    return words;
+}
+
+void HeadwordIndex::runBenchmark(int queries)
+{
+    // Every level at once, the largest list a search box could be given.
+    QStringList english;
+    QStringList hebrew;
+    for (int level = 1; level <= 5; ++level) {
+        QFile file(QString("resources/dictionary_level%1_enhanced.json").arg(level));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const QJsonObject words = QJsonDocument::fromJson(file.readAll()).object();
+        for (auto it = words.begin(); it != words.end(); ++it) {
+            english << it.key();
+            hebrew << it.value().toObject()["translation"].toString();
+        }
+    }
+    if (english.isEmpty()) {
+        qWarning() << "No dictionaries found under resources/";
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    HeadwordIndex index;
+    index.build(english, hebrew);
+    qint64 buildNs = timer.nsecsElapsed();
+
+    // Prefixes of random words as a learner would type them: English,
+    // Hebrew, and Hebrew spelled out from its skeleton ("tz" for צ).
+    QRandomGenerator random(42);
+    QStringList typed;
+    queries = qMax(3, queries);
+    for (int q = 0; q < queries; ++q) {
+        int word = random.bounded(int(english.size()));
+        QString text;
+        switch (q % 3) {
+        case 0:
+            text = english.at(word);
+            break;
+        case 1:
+            text = AnswerText::normalize(hebrew.at(word));
+            break;
+        default:
+            text = skeleton(hebrew.at(word).split(' ').first()).replace('c', "tz");
+            break;
+        }
+        typed << text.left(1 + random.bounded(qMax(1, int(qMin<qsizetype>(text.size(), 5)))));
+    }
+
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    int hits = 0;
+    for (int q = 0; q < typed.size(); ++q) {
+        timer.start();
+        QList<int> found = index.find(typed.at(q), 10);
+        qint64 ns = timer.nsecsElapsed();
+        totalNs += ns;
+        maxNs = qMax(maxNs, ns);
+        hits += found.isEmpty() ? 0 : 1;
+    }
+    qInfo().noquote() << QString("headword search: %1 words, index built in %2 ms, %3 prefix queries avg %4 us, max %5 us (frame 16.7 ms), %6 with results")
+        .arg(index.size())
+        .arg(buildNs / 1e6, 0, 'f', 2)
+        .arg(typed.size())
+        .arg(totalNs / 1e3 / typed.size(), 0, 'f', 2)
+        .arg(maxNs / 1e3, 0, 'f', 2)
+        .arg(hits);
+}
@@ -1,8 +1,9 @@
 #include "MainWindow.h"
-#include "PracticeWindow.h"
-#include "MemoryGame.h"
-#include "StatsTableWidget.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
 #include "UserNameDialog.h"
+#include "SessionCheckpoint.h"
+#include "Trace.h"
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QApplication>
@@ -17,53 +18,68 @@
 #include <QMessageBox>
 #include <QShowEvent>
 
-MainWindow::MainWindow(QWidget* parent)
+MainWindow::MainWindow(const QString& loggedInUser, QWidget* parent)
     : QMainWindow(parent)
+    , stack(nullptr)
+    , menuPage(nullptr)
     , difficultyWindow(nullptr)
+    , memoryGame(nullptr)
+    , practiceWindow(nullptr)
+    , arcadeWindow(nullptr)
+    , statsTable(nullptr)
 {
-    QSettings settings("MyCompany", "EnglishLearningApp");
-    QString userName = settings.value("UserName", "").toString();
+    ELA_TRACE_SCOPE("MainWindow::MainWindow");
+    // main() has just logged the user in; only a window built without a
+    // name falls back to the stored one or a login of its own.
+    QString userName = loggedInUser;
     if (userName.isEmpty()) {
-        UserNameDialog dialog(this);
-        if (dialog.exec() == QDialog::Accepted) {
-            userName = dialog.getUserName();
-            QString password = dialog.getPassword();
-            if (userName == password) {
-                settings.setValue("UserName", userName);
+        ELA_TRACE_BEGIN(settingsSpan, "QSettings UserName");
+        QSettings settings("MyCompany", "EnglishLearningApp");
+        userName = settings.value("UserName", "").toString();
+        ELA_TRACE_END(settingsSpan);
+        if (userName.isEmpty()) {
+            UserNameDialog dialog(this);
+            if (dialog.exec() == QDialog::Accepted) {
+                userName = dialog.getUserName();
+                QString password = dialog.getPassword();
+                if (userName == password) {
+                    settings.setValue("UserName", userName);
+                } else {
+                    QMessageBox::critical(this, "Error", "Username and password do not match!");
+                    QTimer::singleShot(0, this, SLOT(close()));
+                    return;
+                }
             } else {
-                QMessageBox::critical(this, "Error", "Username and password do not match!");
                 QTimer::singleShot(0, this, SLOT(close()));
                 return;
             }
-        } else {
-            QTimer::singleShot(0, this, SLOT(close()));
-            return;
         }
     }
 
-    setWindowTitle("Game Selection");
-
     QIcon windowIcon(":/Learn-English-Icon.png");
     setWindowIcon(windowIcon);
 
-    QLabel* imageLabel = new QLabel(this);
+    stack = new QStackedWidget(this);
+    setCentralWidget(stack);
+
+    menuPage = new QWidget(stack);
+    menuPage->setWindowTitle("Hey " + userName);
+    stack->addWidget(menuPage);
+
+    QLabel* imageLabel = new QLabel(menuPage);
     imageLabel->setScaledContents(true);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     
-    QPixmap pixmap(":/Learn-English.png");
-    imageLabel->setPixmap(pixmap.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    BackgroundCache::applyTo(imageLabel, 1.0, QSize(600, 400));
     imageLabel->setFixedSize(600, 400);
 
-    QWidget* centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
-
-    QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
+    QVBoxLayout* mainLayout = new QVBoxLayout(menuPage);
     mainLayout->setAlignment(Qt::AlignCenter);
 
     mainLayout->addWidget(imageLabel);
     
-    QWidget* contentWidget = new QWidget(this);
-    contentWidget->setStyleSheet("background: transparent;");
+    QWidget* contentWidget = new QWidget(menuPage);
+    AppStyle::setRole(contentWidget, "content");
     QVBoxLayout* contentLayout = new QVBoxLayout(contentWidget);
 
     QGridLayout* buttonGrid = new QGridLayout();
@@ -73,46 +89,27 @@ MainWindow::MainWindow(QWidget* parent)
     QPushButton* btnEnglishMode = new QPushButton("תרגול אנגלית", this);
     QPushButton* btnPracticeMode = new QPushButton("לימוד", this);
     QPushButton* btnMemoryGame = new QPushButton("משחק התאמה", this);
+    QPushButton* btnArcade = new QPushButton("מילים נופלות", this);
     QPushButton* btnScoreTable = new QPushButton("צפה בטבלת ניקוד", this); 
     QPushButton* btnExit = new QPushButton("יציאה", this);
 
-    QString buttonStyle =
-        "QPushButton {"
-        "   background-color: #ebbf00;" 
-        "   color: black;"
-        "   font-size: 18px;"
-        "   padding: 15px;"
-        "   border-radius: 10px;"
-        "   font-weight: bold;"
-        "   box-shadow: 0 4px 6px rgba(0, 0, 0, 0.1);"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #D4A017;"
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #D4A017;"
-        "}";
-
-    btnHebrewMode->setStyleSheet(buttonStyle);
-    btnEnglishMode->setStyleSheet(buttonStyle);
-    btnPracticeMode->setStyleSheet(buttonStyle);
-    btnMemoryGame->setStyleSheet(buttonStyle);
-    btnScoreTable->setStyleSheet(buttonStyle); 
-    btnExit->setStyleSheet(buttonStyle);
+    for (QPushButton* button : { btnHebrewMode, btnEnglishMode, btnPracticeMode, btnMemoryGame, btnArcade, btnScoreTable, btnExit }) {
+        AppStyle::setRole(button, "menu");
+    }
 
     buttonGrid->addWidget(btnHebrewMode, 0, 0);
     buttonGrid->addWidget(btnEnglishMode, 0, 1);
     buttonGrid->addWidget(btnPracticeMode, 1, 0);
     buttonGrid->addWidget(btnMemoryGame, 1, 1);
-    buttonGrid->addWidget(btnScoreTable, 2, 0, 1, 2); 
+    buttonGrid->addWidget(btnArcade, 2, 0);
+    buttonGrid->addWidget(btnScoreTable, 2, 1);
     buttonGrid->addWidget(btnExit, 3, 0, 1, 2); 
 
     contentLayout->addLayout(buttonGrid);
 
     mainLayout->addWidget(contentWidget);
 
-    centralWidget->setLayout(mainLayout);
-
+    showPage(menuPage);
     resize(600, 400);
 
     QScreen* screen = QGuiApplication::primaryScreen();
@@ -129,8 +126,11 @@ MainWindow::MainWindow(QWidget* parent)
     connect(btnEnglishMode, &QPushButton::clicked, this, &MainWindow::openEnglishMode);
     connect(btnPracticeMode, &QPushButton::clicked, this, &MainWindow::openPracticeWindow);
     connect(btnMemoryGame, &QPushButton::clicked, this, &MainWindow::openMemoryGame);
+    connect(btnArcade, &QPushButton::clicked, this, &MainWindow::openArcade);
     connect(btnScoreTable, &QPushButton::clicked, this, &MainWindow::openScoreTable); 
     connect(btnExit, &QPushButton::clicked, this, &MainWindow::exit);
+
+    QTimer::singleShot(0, this, &MainWindow::offerResume);
 }
 
 MainWindow::~MainWindow()
@@ -139,47 +139,180 @@ MainWindow::~MainWindow()
 
 void MainWindow::openHebrewMode()
 {
-    difficultyWindow = new DifficultyWindow("Hebrew", this);
-    difficultyWindow->show();
-    this->hide();
+    openDifficulty("Hebrew");
 }
 
 void MainWindow::openEnglishMode()
 {
-    difficultyWindow = new DifficultyWindow("English", this);
-    difficultyWindow->show();
-    this->hide();
+    openDifficulty("English");
 }
 
 void MainWindow::openPracticeWindow()
 {
-    difficultyWindow = new DifficultyWindow("Practice", this);
-    difficultyWindow->show();
-    this->hide();
+    openDifficulty("Practice");
 }
 
 void MainWindow::openMemoryGame()
 {
-    difficultyWindow = new DifficultyWindow("Memory", this);
-    difficultyWindow->show();
-    this->hide();
+    openDifficulty("Memory");
 }
 
-void MainWindow::updateStatsTable(int score)
+void MainWindow::openArcade()
 {
-    StatsTableWidget* statsTable = new StatsTableWidget();
-    statsTable->addScore("MemoryGame", score);
-    statsTable->setWindowTitle("Score Table");
-    statsTable->resize(500, 400);
-    statsTable->show();
+    openDifficulty("Arcade");
+}
+
+void MainWindow::openDifficulty(const QString& mode)
+{
+    if (!difficultyWindow) {
+        difficultyWindow = new DifficultyWindow(stack);
+        stack->addWidget(difficultyWindow);
+        connect(difficultyWindow, &DifficultyWindow::levelChosen, this, &MainWindow::startLevel);
+        connect(difficultyWindow, &DifficultyWindow::backRequested, this, &MainWindow::showMenu);
+    }
+    difficultyWindow->setMode(mode);
+    showPage(difficultyWindow);
+}
+
+void MainWindow::startLevel(const QString& mode, const QString& jsonFile)
+{
+    ELA_TRACE_SCOPE("MainWindow::startLevel");
+
+    if (mode == "Hebrew" || mode == "English") {
+        GameWindow* page = gamePage(mode);
+        page->start(jsonFile);
+        showPage(page);
+    }
+    else if (mode == "Memory") {
+        MemoryGame* page = memoryGamePage();
+        page->start(jsonFile);
+        showPage(page);
+    }
+    else if (mode == "Practice") {
+        PracticeWindow* page = practicePage();
+        page->start(jsonFile);
+        showPage(page);
+    }
+    else if (mode == "Arcade") {
+        ArcadeWindow* page = arcadePage();
+        page->start(jsonFile);
+        showPage(page);
+    }
+}
+
+void MainWindow::resumeSession(const SessionState& state)
+{
+    ELA_TRACE_SCOPE("MainWindow::resumeSession");
+    // Leaving the resumed game lands on the level list, as after a fresh start.
+    openDifficulty(state.gameMode);
+
+    if (state.gameMode == "Hebrew" || state.gameMode == "English") {
+        GameWindow* page = gamePage(state.gameMode);
+        page->restoreSession(state);
+        showPage(page);
+    }
+    else if (state.gameMode == "Memory") {
+        MemoryGame* page = memoryGamePage();
+        page->restoreSession(state);
+        showPage(page);
+    }
+    else if (state.gameMode == "Practice") {
+        PracticeWindow* page = practicePage();
+        page->restoreSession(state);
+        showPage(page);
+    }
+}
+
+GameWindow* MainWindow::gamePage(const QString& mode)
+{
+    GameWindow* page = gameWindows.value(mode);
+    if (!page) {
+        page = new GameWindow(mode, stack);
+        stack->addWidget(page);
+        connect(page, &GameWindow::finished, this, &MainWindow::showDifficulty);
+        gameWindows.insert(mode, page);
+    }
+    return page;
+}
+
+MemoryGame* MainWindow::memoryGamePage()
+{
+    if (!memoryGame) {
+        memoryGame = new MemoryGame(stack);
+        stack->addWidget(memoryGame);
+        connect(memoryGame, &MemoryGame::finished, this, &MainWindow::showDifficulty);
+    }
+    return memoryGame;
+}
+
+PracticeWindow* MainWindow::practicePage()
+{
+    if (!practiceWindow) {
+        practiceWindow = new PracticeWindow(stack);
+        stack->addWidget(practiceWindow);
+        connect(practiceWindow, &PracticeWindow::finished, this, &MainWindow::showDifficulty);
+    }
+    return practiceWindow;
+}
+
+ArcadeWindow* MainWindow::arcadePage()
+{
+    if (!arcadeWindow) {
+        arcadeWindow = new ArcadeWindow(stack);
+        stack->addWidget(arcadeWindow);
+        connect(arcadeWindow, &ArcadeWindow::finished, this, &MainWindow::showDifficulty);
+    }
+    return arcadeWindow;
+}
+
+void MainWindow::showPage(QWidget* page)
+{
+    stack->setCurrentWidget(page);
+    setWindowTitle(page->windowTitle());
+}
+
+void MainWindow::showMenu()
+{
+    showPage(menuPage);
+}
+
+void MainWindow::showDifficulty()
+{
+    showPage(difficultyWindow);
+}
+
+void MainWindow::offerResume()
+{
+    QString userName = SessionCheckpoint::currentUserName();
+    SessionState state;
+    if (!SessionCheckpoint::load(userName, state)) {
+        return;
+    }
+
+    QMessageBox::StandardButton answer = QMessageBox::question(this, "המשך משחק",
+        "נמצא משחק שלא הסתיים. להמשיך מאותה נקודה?");
+    if (answer != QMessageBox::Yes) {
+        SessionCheckpoint(userName).clear();
+        return;
+    }
+
+    resumeSession(state);
 }
 
 void MainWindow::openScoreTable()
 {
-    StatsTableWidget* statsTable = new StatsTableWidget();
-    statsTable->setWindowTitle("Score Table");
-    statsTable->resize(500, 400);
+    ELA_TRACE_SCOPE("MainWindow::openScoreTable");
+    if (!statsTable) {
+        statsTable = new StatsTableWidget(this);
+        statsTable->setWindowFlag(Qt::Window);
+        statsTable->setWindowTitle("Score Table");
+        statsTable->resize(500, 400);
+    } else {
+        statsTable->refreshTable();
+    }
     statsTable->show();
+    statsTable->raise();
+    statsTable->activateWindow();
 }
 
 void MainWindow::exit()
@@ -0,0 +1,314 @@
+#include "MemoryBoard.h"
+#include "AppStyle.h"
+#include "Trace.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QRandomGenerator>
+#include <QResizeEvent>
+#include <QScreen>
+#include <QShortcut>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+const QSizeF kCardSize(120, 50);
+const qreal kGap = 10;
+const qreal kLift = 20;
+}
+
+MemoryBoard::MemoryBoard(QWidget* parent)
+    : QGraphicsView(parent)
+    , scene(new QGraphicsScene(this))
+    , monitor("memory board")
+{
+    ELA_TRACE_SCOPE("MemoryBoard::MemoryBoard");
+    // Cards move all the time and there are at most a hundred of them, so
+    // a BSP index would cost more to maintain than it saves.
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    setScene(scene);
+
+    AppStyle::setRole(this, "board");
+    setRenderHint(QPainter::Antialiasing);
+    setRenderHint(QPainter::TextAntialiasing);
+    setOptimizationFlags(QGraphicsView::DontSavePainterState);
+    setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setFrameShape(QFrame::NoFrame);
+
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        monitor.setRefreshRate(screen->refreshRate());
+    }
+    if (monitor.isEnabled()) {
+        QShortcut* dump = new QShortcut(QKeySequence("Ctrl+Shift+F"), this);
+        connect(dump, &QShortcut::activated, this, &MemoryBoard::dumpFrameStats);
+    }
+}
+
+MemoryBoard::~MemoryBoard()
+{
+    if (FrameMonitor::instrumentationEnabled() && monitor.frames() > 0) {
+        dumpFrameStats();
+    }
+}
+
+void MemoryBoard::setColumns(int columns)
+{
+    columnCount = qBound(1, columns, kMaxColumns);
+}
+
+int MemoryBoard::columns() const
+{
+    return columnCount;
+}
+
+void MemoryBoard::setCards(const QStringList& words)
+{
+    clear();
+
+    for (int i = 0; i < words.size() && i < kMaxColumns * kMaxRows; ++i) {
+        CardItem* card = takeCard(words[i]);
+        int row = i / columnCount;
+        int column = i % columnCount;
+        card->setHome(QPointF(column * (kCardSize.width() + kGap), row * (kCardSize.height() + kGap)));
+        items.append(card);
+    }
+
+    int rows = (items.size() + columnCount - 1) / columnCount;
+    scene->setSceneRect(-kGap, -kLift - kGap,
+                        columnCount * (kCardSize.width() + kGap) + kGap,
+                        rows * (kCardSize.height() + kGap) + kLift + kGap);
+    fitScene();
+}
+
+void MemoryBoard::clear()
+{
+    for (CardItem* card : items) {
+        card->retire();
+        spare.append(card);
+    }
+    items.clear();
+}
+
+CardItem* MemoryBoard::takeCard(const QString& word)
+{
+    if (!spare.isEmpty()) {
+        CardItem* card = spare.takeLast();
+        card->reset(word);
+        ++stats.reused;
+        return card;
+    }
+
+    CardItem* card = new CardItem(word, kCardSize);
+    scene->addItem(card);
+    connect(card, &CardItem::clicked, this, [this, card]() {
+        emit cardClicked(card);
+    });
+    connect(card, &CardItem::animationRunningChanged, this, &MemoryBoard::trackAnimation);
+    ++stats.created;
+    return card;
+}
+
+MemoryBoard::PoolStats MemoryBoard::poolStats() const
+{
+    PoolStats current = stats;
+    current.inUse = items.size();
+    current.spare = spare.size();
+    return current;
+}
+
+int MemoryBoard::objectCount() const
+{
+    // Scene items have no QObject parent, so findChildren() alone misses them.
+    int count = findChildren<QObject*>().size();
+    for (QGraphicsItem* item : scene->items()) {
+        if (QGraphicsObject* object = item->toGraphicsObject()) {
+            count += 1 + object->findChildren<QObject*>().size();
+        }
+    }
+    return count;
+}
+
+QList<CardItem*> MemoryBoard::cards() const
+{
+    return items;
+}
+
+CardItem* MemoryBoard::card(const QString& word) const
+{
+    for (CardItem* card : items) {
+        if (card->word() == word && card->isVisible()) {
+            return card;
+        }
+    }
+    return nullptr;
+}
+
+void MemoryBoard::playFlip(CardItem* card)
+{
+    card->bounce(QPointF(0, -kLift / 2), 300);
+}
+
+void MemoryBoard::playMatch(CardItem* first, CardItem* second)
+{
+    first->vanish(QPointF(0, -kLift), 500);
+    second->vanish(QPointF(0, -kLift), 500);
+}
+
+void MemoryBoard::playMismatch(CardItem* first, CardItem* second)
+{
+    first->bounce(QPointF(-5, 0), 200);
+    second->bounce(QPointF(5, 0), 200);
+}
+
+void MemoryBoard::trackAnimation(bool running)
+{
+    runningAnimations += running ? 1 : -1;
+    if (running && runningAnimations == 1) {
+        monitor.beginBurst();
+    } else if (!running && runningAnimations == 0) {
+        monitor.endBurst();
+    }
+}
+
+FrameMonitor& MemoryBoard::frameMonitor()
+{
+    return monitor;
+}
+
+void MemoryBoard::dumpFrameStats() const
+{
+    qInfo().noquote() << monitor.summary();
+}
+
+void MemoryBoard::resizeEvent(QResizeEvent* event)
+{
+    QGraphicsView::resizeEvent(event);
+    fitScene();
+}
+
+void MemoryBoard::fitScene()
+{
+    if (!scene->sceneRect().isEmpty()) {
+        fitInView(scene->sceneRect(), Qt::KeepAspectRatio);
+    }
+}
+
+void MemoryBoard::paintEvent(QPaintEvent* event)
+{
+    if (!monitor.isRecording()) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    qint64 start = monitor.now();
+    QGraphicsView::paintEvent(event);
+    monitor.framePainted(start, monitor.now() - start);
+}
+
+void MemoryBoard::runBenchmark(int columns, int rows, int milliseconds)
+{
+    columns = qBound(1, columns, kMaxColumns);
+    rows = qBound(1, rows, kMaxRows);
+
+    MemoryBoard board;
+    board.resize(580, 300);
+    board.setColumns(columns);
+    QStringList words;
+    for (int i = 0; i < columns * rows; ++i) {
+        words.append(i % 2 ? QString("מילה %1").arg(i) : QString("word %1").arg(i));
+    }
+    board.setCards(words);
+    board.show();
+    QApplication::processEvents();
+
+    board.monitor.setEnabled(true);
+    board.monitor.clear();
+    qint64 startNs = board.monitor.now();
+    // Every card bobs at once, which is far more than a game ever animates.
+    const QList<CardItem*> cards = board.cards();
+    for (int i = 0; i < cards.size(); ++i) {
+        cards[i]->bounce(QPointF(0, -kLift / 2), 600 + (i % 7) * 40, -1);
+    }
+    QEventLoop loop;
+    QTimer::singleShot(milliseconds, &loop, &QEventLoop::quit);
+    loop.exec();
+    qint64 elapsedNs = board.monitor.now() - startNs;
+    board.clear();
+
+    if (board.monitor.frames() < 2) {
+        qWarning() << "memory board: no frames were painted";
+        return;
+    }
+    qInfo().noquote() << QString("%1x%2 board at %3 fps; ")
+        .arg(columns).arg(rows)
+        .arg(board.monitor.frames() * 1e9 / elapsedNs, 0, 'f', 1)
+        + board.monitor.summary();
+    board.monitor.clear();
+}
+
+bool MemoryBoard::runPoolCheck(int rounds)
+{
+    static const QList<QPair<int, int>> grids = {
+        { 2, 5 }, { 4, 4 }, { 4, 6 }, { 6, 6 }, { 8, 8 }, { 10, 10 }
+    };
+
+    MemoryBoard board;
+    board.resize(580, 300);
+    QRandomGenerator random(36);
+
+    auto playRound = [&board, &random](int round) {
+        const QPair<int, int>& grid = grids[random.bounded(grids.size())];
+        board.setColumns(grid.first);
+        QStringList words;
+        for (int i = 0; i < grid.first * grid.second; ++i) {
+            words.append(QString("%1-%2").arg(round).arg(i));
+        }
+        board.setCards(words);
+
+        // Start every kind of animation and abandon some halfway, as a
+        // player who resets mid-game does.
+        const QList<CardItem*> cards = board.cards();
+        for (int i = 0; i + 1 < cards.size(); i += 2) {
+            switch (random.bounded(3)) {
+            case 0: board.playFlip(cards[i]); break;
+            case 1: board.playMatch(cards[i], cards[i + 1]); break;
+            default: board.playMismatch(cards[i], cards[i + 1]); break;
+            }
+        }
+        QApplication::processEvents();
+    };
+
+    // The largest grid once up front, so later rounds never need a new card.
+    board.setColumns(kMaxColumns);
+    QStringList full;
+    for (int i = 0; i < kMaxColumns * kMaxRows; ++i) {
+        full.append(QString::number(i));
+    }
+    board.setCards(full);
+    board.clear();
+    int baselineObjects = board.objectCount();
+    int baselineCreated = board.poolStats().created;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; ++round) {
+        playRound(round);
+    }
+    board.clear();
+    QApplication::processEvents();
+    qint64 elapsedMs = timer.elapsed();
+
+    PoolStats pool = board.poolStats();
+    int objects = board.objectCount();
+    bool flat = pool.created == baselineCreated && objects == baselineObjects
+        && pool.spare == pool.created && pool.inUse == 0;
+
+    qInfo().noquote() << QString("card pool: %1 rounds in %2 ms, %3 cards created, %4 reused, %5 spare, objects %6 -> %7: %8")
+        .arg(rounds).arg(elapsedMs)
+        .arg(pool.created).arg(pool.reused).arg(pool.spare)
+        .arg(baselineObjects).arg(objects)
+        .arg(flat ? "flat" : "GROWING");
+    return flat;
+}
@@ -1,4 +1,12 @@
 #include "MemoryGame.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
+#include "ProgressLog.h"
+#include "ProgressStats.h"
+#include "ProgressSync.h"
+#include "ConfusionMatrix.h"
+#include "SoundBank.h"
+#include "Trace.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -6,88 +14,75 @@
 #include <QTimer>
 #include <random>
 #include <QSettings>
-#include <QScreen>
-#include <QGuiApplication>
-#include <QPainter>
-#include <QPropertyAnimation>
-#include <QParallelAnimationGroup>
-#include <QSoundEffect>
-
-MemoryGame::MemoryGame(const QString& jsonFilePath, QWidget* parent)
-    : QMainWindow(parent), jsonFilePath(jsonFilePath) {
-    loadWords(jsonFilePath);
-    setupSoundEffects();
+
+MemoryGame::MemoryGame(QWidget* parent)
+    : QWidget(parent), checkpoint(SessionCheckpoint::currentUserName()) {
+    ELA_TRACE_SCOPE("MemoryGame::MemoryGame");
     initializeUI();
-    setupGameBoard();
 }
 
-void MemoryGame::setupSoundEffects() {
-    matchSound = new QSoundEffect(this);
-    matchSound->setSource(QUrl::fromLocalFile(":/sounds/match.wav"));
-    matchSound->setVolume(0.5f);
+void MemoryGame::start(const QString& jsonFilePath) {
+    if (jsonFilePath != this->jsonFilePath || wordsMap.isEmpty()) {
+        this->jsonFilePath = jsonFilePath;
+        loadWords(jsonFilePath);
+    }
+    resetGame();
+    // The sounds load after the board has painted; nothing plays before
+    // the first click anyway.
+    QTimer::singleShot(0, this, []() { SoundBank::instance().preload(); });
+}
 
-    mismatchSound = new QSoundEffect(this);
-    mismatchSound->setSource(QUrl::fromLocalFile(":/sounds/mismatch.wav"));
-    mismatchSound->setVolume(0.5f);
+void MemoryGame::restoreSession(const SessionState& state) {
+    if (state.level != jsonFilePath || wordsMap.isEmpty()) {
+        jsonFilePath = state.level;
+        loadWords(jsonFilePath);
+    }
+    clearBoard();
+    buildBoard(state.board, state.boardTranslations);
+
+    for (const QString& word : state.answered) {
+        CardItem* englishCard = board->card(word);
+        CardItem* hebrewCard = board->card(wordsMap.value(word));
+        if (englishCard && hebrewCard) {
+            removePair(englishCard, hebrewCard);
+            matchedWords.append(word);
+        }
+    }
+    matchedPairs = matchedWords.size();
 
-    flipSound = new QSoundEffect(this);
-    flipSound->setSource(QUrl::fromLocalFile(":/sounds/flip.wav"));
-    flipSound->setVolume(0.5f);
+    beginCheckpoint();
+    QTimer::singleShot(0, this, []() { SoundBank::instance().preload(); });
 }
 
-void MemoryGame::playCardFlipAnimation(QPushButton* button) {
-    QPropertyAnimation* animation = new QPropertyAnimation(button, "geometry");
-    animation->setDuration(300);
-    animation->setStartValue(button->geometry());
-    animation->setEndValue(QRect(button->x(), button->y() - 10, button->width(), button->height()));
-    animation->setEasingCurve(QEasingCurve::OutBounce);
-    animation->start(QAbstractAnimation::DeleteWhenStopped);
-    flipSound->play();
+void MemoryGame::beginCheckpoint() {
+    SessionState state;
+    state.gameMode = "Memory";
+    state.level = jsonFilePath;
+    state.score = matchedPairs;
+    state.currentWordCount = matchedPairs;
+    state.answered = matchedWords;
+    state.board = boardWords;
+    state.boardTranslations = boardTranslations;
+    checkpoint.begin(state);
 }
 
-void MemoryGame::playMatchAnimation(QPushButton* button1, QPushButton* button2) {
-    QParallelAnimationGroup* group = new QParallelAnimationGroup(this);
-
-    QPropertyAnimation* anim1 = new QPropertyAnimation(button1, "geometry");
-    anim1->setDuration(500);
-    anim1->setStartValue(button1->geometry());
-    anim1->setEndValue(QRect(button1->x(), button1->y() - 20, button1->width(), button1->height()));
-    anim1->setEasingCurve(QEasingCurve::OutBounce);
-
-    QPropertyAnimation* anim2 = new QPropertyAnimation(button2, "geometry");
-    anim2->setDuration(500);
-    anim2->setStartValue(button2->geometry());
-    anim2->setEndValue(QRect(button2->x(), button2->y() - 20, button2->width(), button2->height()));
-    anim2->setEasingCurve(QEasingCurve::OutBounce);
-
-    group->addAnimation(anim1);
-    group->addAnimation(anim2);
-    group->start(QAbstractAnimation::DeleteWhenStopped);
-    matchSound->play();
+void MemoryGame::playCardFlipAnimation(CardItem* card) {
+    board->playFlip(card);
+    SoundBank::instance().play(SoundBank::Flip);
 }
 
-void MemoryGame::playMismatchAnimation(QPushButton* button1, QPushButton* button2) {
-    QParallelAnimationGroup* group = new QParallelAnimationGroup(this);
-
-    QPropertyAnimation* anim1 = new QPropertyAnimation(button1, "geometry");
-    anim1->setDuration(200);
-    anim1->setStartValue(button1->geometry());
-    anim1->setEndValue(QRect(button1->x() - 5, button1->y(), button1->width(), button1->height()));
-    anim1->setEasingCurve(QEasingCurve::InOutQuad);
-
-    QPropertyAnimation* anim2 = new QPropertyAnimation(button2, "geometry");
-    anim2->setDuration(200);
-    anim2->setStartValue(button2->geometry());
-    anim2->setEndValue(QRect(button2->x() + 5, button2->y(), button2->width(), button2->height()));
-    anim2->setEasingCurve(QEasingCurve::InOutQuad);
-
-    group->addAnimation(anim1);
-    group->addAnimation(anim2);
-    group->start(QAbstractAnimation::DeleteWhenStopped);
-    mismatchSound->play();
+void MemoryGame::playMatchAnimation(CardItem* card1, CardItem* card2) {
+    board->playMatch(card1, card2);
+    SoundBank::instance().play(SoundBank::Match);
+}
+
+void MemoryGame::playMismatchAnimation(CardItem* card1, CardItem* card2) {
+    board->playMismatch(card1, card2);
+    SoundBank::instance().play(SoundBank::Mismatch);
 }
 
 void MemoryGame::loadWords(const QString& level) {
+    ELA_TRACE_SCOPE("MemoryGame::loadWords");
     QString filePath = level;
     if (!filePath.startsWith("resources/")) {
         filePath = QString("resources/%1").arg(level);
@@ -107,14 +102,14 @@ void MemoryGame::loadWords(const QString& level) {
     if (doc.isObject()) {
         QJsonObject jsonObject = doc.object();
         wordsMap.clear();
-        englishWords.clear();
+        hebrewToEnglish.clear();
         
         for (auto it = jsonObject.begin(); it != jsonObject.end(); ++it) {
             QJsonObject wordObj = it.value().toObject();
             QString englishWord = it.key();
             QString hebrewWord = wordObj["translation"].toString();
             wordsMap.insert(englishWord, hebrewWord);
-            englishWords.append(englishWord);
+            hebrewToEnglish.insert(hebrewWord, englishWord);
         }
     }
     file.close();
@@ -122,41 +117,36 @@ void MemoryGame::loadWords(const QString& level) {
 
 void MemoryGame::initializeUI() {
     setWindowTitle("Memory Game");
-    QIcon windowIcon(":/Learn-English-Icon.png");
-    setWindowIcon(windowIcon);
-
-    QWidget* centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
-
-    QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(0, 0, 0, 0);
 
-    QLabel* imageLabel = new QLabel(centralWidget);
+    QLabel* imageLabel = new QLabel(this);
     imageLabel->setScaledContents(true);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-    QPixmap pixmap(":/Learn-English.png");
-    QImage image = pixmap.toImage();
-    QImage transparentImage(image.size(), QImage::Format_ARGB32);
-    transparentImage.fill(Qt::transparent);
-
-    QPainter painter(&transparentImage);
-    painter.setOpacity(0.3);
-    painter.drawImage(0, 0, image);
-    painter.end();
-
-    QPixmap transparentPixmap = QPixmap::fromImage(transparentImage);
-    imageLabel->setPixmap(transparentPixmap.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    BackgroundCache::applyTo(imageLabel, 0.3, QSize(600, 400));
     imageLabel->setFixedSize(600, 400);
     imageLabel->setGeometry(0, 0, 600, 400);
     imageLabel->lower();
 
-    QWidget* contentWidget = new QWidget(centralWidget);
-    contentWidget->setStyleSheet("background: transparent;");
+    QWidget* contentWidget = new QWidget(this);
+    AppStyle::setRole(contentWidget, "content");
     QVBoxLayout* contentLayout = new QVBoxLayout(contentWidget);
 
-    cardGrid = new QGridLayout();
-    contentLayout->addLayout(cardGrid);
+    board = new MemoryBoard(this);
+    connect(board, &MemoryBoard::cardClicked, this, &MemoryGame::handleCardClick);
+    contentLayout->addWidget(board, 1);
+
+    gridCombo = new QComboBox(this);
+    const QList<QSize> gridSizes = { QSize(2, 5), QSize(4, 4), QSize(4, 6), QSize(6, 6), QSize(8, 8), QSize(10, 10) };
+    for (const QSize& grid : gridSizes) {
+        gridCombo->addItem(QString("%1×%2").arg(grid.width()).arg(grid.height()), grid);
+    }
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    QSize currentGrid(settings.value("MemoryGridColumns", 2).toInt(), settings.value("MemoryGridRows", 5).toInt());
+    gridCombo->setCurrentIndex(qMax(0, gridCombo->findData(currentGrid)));
+    board->setColumns(gridCombo->currentData().toSize().width());
+    connect(gridCombo, &QComboBox::currentIndexChanged, this, &MemoryGame::changeGridSize);
 
     QPushButton* resetBtn = new QPushButton("איפוס משחק", this);
     connect(resetBtn, &QPushButton::clicked, this, &MemoryGame::resetGame);
@@ -164,51 +154,35 @@ void MemoryGame::initializeUI() {
     QPushButton* backBtn = new QPushButton("חזור", this);
     connect(backBtn, &QPushButton::clicked, this, &MemoryGame::goBack);
 
-    QString buttonStyle =
-        "QPushButton {"
-        "   background-color: #f1c70c;" 
-        "   color: black;" 
-        "   font-size: 16px;"
-        "   padding: 10px;"
-        "   border-radius: 8px;" 
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f5d33f;" 
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #f5d33f;" 
-        "}";
-
-    resetBtn->setStyleSheet(buttonStyle);
-    backBtn->setStyleSheet(buttonStyle);
+    AppStyle::setRole(resetBtn, "action");
+    AppStyle::setRole(backBtn, "action");
 
     QHBoxLayout* buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(backBtn);
     buttonLayout->addWidget(resetBtn);
+    buttonLayout->addWidget(gridCombo);
     contentLayout->addLayout(buttonLayout);
 
     mainLayout->addWidget(contentWidget);
-
-    resize(600, 400);
-
-    QScreen* screen = QGuiApplication::primaryScreen();
-    if (screen) {
-        QRect screenGeometry = screen->geometry();
-        int x = (screenGeometry.width() - this->width()) / 2;
-        int y = (screenGeometry.height() - this->height()) / 2;
-        this->move(x, y);
-    }
 }
 
 void MemoryGame::setupGameBoard() {
     std::random_device rd;
     std::mt19937 g(rd());
+    // Start from the whole level every time; the page outlives its games.
+    QList<QString> englishWords = wordsMap.keys();
     std::shuffle(englishWords.begin(), englishWords.end(), g);
 
+    QSize grid = gridCombo->currentData().toSize();
+    int pairs = grid.width() * grid.height() / 2;
+
     filterUsedWords(englishWords);
+    if (englishWords.size() < pairs) {
+        englishWords = wordsMap.keys();
+        std::shuffle(englishWords.begin(), englishWords.end(), g);
+    }
 
-    QList<QString> selectedWords = englishWords.mid(0, 5);
+    QList<QString> selectedWords = englishWords.mid(0, pairs);
 
     QList<QString> selectedHebrewWords;
     for (const QString& word : selectedWords) {
@@ -217,158 +191,143 @@ void MemoryGame::setupGameBoard() {
 
     std::shuffle(selectedHebrewWords.begin(), selectedHebrewWords.end(), g);
 
-    englishButtons.clear();
-    hebrewButtons.clear();
-
-    for (int i = 0; i < selectedWords.size(); ++i) {
-        QString englishWord = selectedWords[i];
-        QString hebrewTranslation = selectedHebrewWords[i];
-
-        QPushButton* englishBtn = new QPushButton(englishWord);
-        QPushButton* hebrewBtn = new QPushButton(hebrewTranslation);
-
-        setButtonStyle(englishBtn, "#f1c70c"); 
-        setButtonStyle(hebrewBtn, "#f1c70c");
-
-        englishBtn->setProperty("word", englishWord);
-        hebrewBtn->setProperty("word", hebrewTranslation);
-
-        connect(englishBtn, &QPushButton::clicked, this, &MemoryGame::handleCardClick);
-        connect(hebrewBtn, &QPushButton::clicked, this, &MemoryGame::handleCardClick);
-
-        englishButtons.append(englishBtn);
-        hebrewButtons.append(hebrewBtn);
-    }
+    buildBoard(selectedWords, selectedHebrewWords);
+    saveUsedWords(selectedWords);
+    beginCheckpoint();
+}
 
-    int row = 0;
-    for (int i = 0; i < englishButtons.size(); ++i) {
-        cardGrid->addWidget(englishButtons[i], row, 0);
-        cardGrid->addWidget(hebrewButtons[i], row, 1);
-        row++;
+void MemoryGame::buildBoard(const QList<QString>& words, const QList<QString>& translations) {
+    matchedWords.clear();
+    boardWords = words;
+    boardTranslations = translations;
+
+    // English and Hebrew cards alternate, so the classic 2-column board
+    // keeps English on one side and Hebrew on the other.
+    QStringList cards;
+    for (int i = 0; i < words.size() && i < translations.size(); ++i) {
+        cards.append(words[i]);
+        cards.append(translations[i]);
     }
-
-    saveUsedWords(selectedWords);
+    board->setCards(cards);
 }
 
-void MemoryGame::handleCardClick() {
-    QPushButton* clickedButton = qobject_cast<QPushButton*>(sender());
-    if (!clickedButton) return;
+void MemoryGame::changeGridSize(int index) {
+    QSize grid = gridCombo->itemData(index).toSize();
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    settings.setValue("MemoryGridColumns", grid.width());
+    settings.setValue("MemoryGridRows", grid.height());
+    board->setColumns(grid.width());
+    resetGame();
+}
 
-    if (!clickedButton->isEnabled()) return;
+void MemoryGame::handleCardClick(CardItem* card) {
+    if (!card->isEnabled() || card == firstSelectedCard) return;
 
-    playCardFlipAnimation(clickedButton);
+    playCardFlipAnimation(card);
 
-    if (!firstSelectedButton) {
-        firstSelectedButton = clickedButton;
-        setButtonStyle(firstSelectedButton, "#ffe066"); 
+    if (!firstSelectedCard) {
+        firstSelectedCard = card;
+        card->setState(CardItem::Selected);
         return;
     }
 
-    setButtonStyle(clickedButton, "#ffe066"); 
-    clickedButton->setEnabled(false);
+    card->setState(CardItem::Selected);
+    card->setEnabled(false);
 
-    QString firstWord = firstSelectedButton->property("word").toString();
-    QString secondWord = clickedButton->property("word").toString();
+    QString firstWord = firstSelectedCard->word();
+    QString secondWord = card->word();
 
     bool isMatch = (wordsMap[firstWord] == secondWord) || (wordsMap[secondWord] == firstWord);
 
-    clickedButton->setEnabled(false);
-
-    QPushButton* firstButton = firstSelectedButton;
+    CardItem* firstCard = firstSelectedCard;
+    ProgressLog::record("MemoryGame", jsonFilePath, wordsMap.contains(firstWord) ? firstWord : secondWord, isMatch);
 
     if (isMatch) {
-        playMatchAnimation(firstButton, clickedButton);
-        handleMatch(firstButton, clickedButton);
+        playMatchAnimation(firstCard, card);
+        handleMatch(firstCard, card);
     } else {
-        playMismatchAnimation(firstButton, clickedButton);
-        QTimer::singleShot(1000, this, [this, firstButton, clickedButton]() {
-            handleMismatch(firstButton, clickedButton);
+        bool firstIsEnglish = wordsMap.contains(firstWord);
+        if (firstIsEnglish != wordsMap.contains(secondWord)) {
+            ConfusionMatrix::instance().record(SessionCheckpoint::currentUserName(),
+                firstIsEnglish ? firstWord : hebrewToEnglish.value(firstWord),
+                firstIsEnglish ? hebrewToEnglish.value(secondWord) : secondWord);
+        }
+        playMismatchAnimation(firstCard, card);
+        int round = boardRound;
+        QTimer::singleShot(1000, this, [this, round, firstCard, card]() {
+            if (round == boardRound) {
+                handleMismatch(firstCard, card);
+            }
         });
     }
 
-    firstSelectedButton = nullptr;
+    firstSelectedCard = nullptr;
 }
 
-void MemoryGame::handleMatch(QPushButton* firstButton, QPushButton* secondButton) {
-    cardGrid->removeWidget(firstButton);
-    cardGrid->removeWidget(secondButton);
-    firstButton->setParent(nullptr);
-    secondButton->setParent(nullptr);
+void MemoryGame::handleMatch(CardItem* firstCard, CardItem* secondCard) {
+    QString firstWord = firstCard->word();
+    QString englishWord = wordsMap.contains(firstWord) ? firstWord : secondCard->word();
+
+    // The board hides the pair once its match animation has played.
+    firstCard->setEnabled(false);
+    secondCard->setEnabled(false);
 
     matchedPairs++;
+    matchedWords.append(englishWord);
+    checkpoint.recordAnswer(englishWord, matchedPairs, matchedPairs);
 
-    if (matchedPairs == 5) {
+    if (matchedPairs == boardWords.size()) {
         int score = matchedPairs;
         saveScore("MemoryGame", score);
+        checkpoint.clear();
     }
 }
 
+void MemoryGame::removePair(CardItem* firstCard, CardItem* secondCard) {
+    firstCard->hide();
+    secondCard->hide();
+}
+
 void MemoryGame::saveScore(const QString& gameType, int score) {
     QSettings settings("MyCompany", "EnglishLearningApp");
     QString userName = settings.value("UserName", "").toString();
     QString key = QString("%1/%2/score").arg(userName).arg(gameType);
 
-    int currentScore = settings.value(key, 0).toInt();
-    settings.setValue(key, currentScore + score);
+    ProgressSync::addScore(settings, userName, gameType, score);
+    ProgressStats::instance().raiseScore(userName, gameType, settings.value(key, 0).toInt());
 }
 
-void MemoryGame::handleMismatch(QPushButton* firstButton, QPushButton* secondButton) {
-    setButtonStyle(firstButton, "red");
-    setButtonStyle(secondButton, "red");
+void MemoryGame::handleMismatch(CardItem* firstCard, CardItem* secondCard) {
+    firstCard->setState(CardItem::Mismatch);
+    secondCard->setState(CardItem::Mismatch);
 
-    QTimer::singleShot(1000, this, [this, firstButton, secondButton]() {
-        setButtonStyle(firstButton, "#f1c70c"); 
-        setButtonStyle(secondButton, "#f1c70c");
-        firstButton->setEnabled(true);
-        secondButton->setEnabled(true);
+    int round = boardRound;
+    QTimer::singleShot(1000, this, [this, round, firstCard, secondCard]() {
+        if (round != boardRound) {
+            return;
+        }
+        for (CardItem* card : { firstCard, secondCard }) {
+            card->setState(CardItem::Normal);
+            card->setEnabled(true);
+        }
     });
 }
 
-void MemoryGame::setButtonStyle(QPushButton* button, const QString& color) {
-    QString styleSheet = QString(
-        "QPushButton {"
-        "   background-color: %1;"
-        "   color: black;" 
-        "   font-size: 16px;"
-        "   min-width: 100px;"
-        "   min-height: 50px;"
-        "   border-radius: 8px;" 
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f5d33f;" 
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #f5d33f;" 
-        "}"
-    ).arg(color);
-
-    button->setStyleSheet(styleSheet);
+void MemoryGame::resetGame() {
+    clearBoard();
+    setupGameBoard();
 }
 
-void MemoryGame::resetGame() {
+void MemoryGame::clearBoard() {
     matchedPairs = 0;
-    firstSelectedButton = nullptr;
-
-    for (auto button : englishButtons) {
-        cardGrid->removeWidget(button);
-        delete button;
-    }
-    for (auto button : hebrewButtons) {
-        cardGrid->removeWidget(button);
-        delete button;
-    }
-    englishButtons.clear();
-    hebrewButtons.clear();
-
-    setupGameBoard();
+    firstSelectedCard = nullptr;
+    ++boardRound;
+    board->clear();
 }
 
 void MemoryGame::goBack() {
-    if (parentWidget()) {
-        parentWidget()->show();
-    }
-    this->close();
+    checkpoint.clear();
+    emit finished();
 }
 
 void MemoryGame::filterUsedWords(QList<QString>& words) {
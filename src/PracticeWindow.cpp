@@ -1,150 +1,168 @@
 ﻿#include "PracticeWindow.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
+#include "ProgressLog.h"
+#include "ProgressSync.h"
+#include "PronunciationScorer.h"
+#include "SpeechService.h"
+#include "Trace.h"
+#include <QAudioSource>
+#include <QMediaDevices>
 #include <QVBoxLayout>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QDebug>
 #include <QMessageBox>
-#include <QScreen>
-#include <QGuiApplication>
-#include <QPainter>
+#include <QTimer>
 
-PracticeWindow::PracticeWindow(const QString& jsonFile, QWidget* parent)
-    : QMainWindow(parent), currentIndex(0), textToSpeech(new QTextToSpeech(this)) {
-    setWindowTitle("תרגול אנגלית");
-
-    QIcon windowIcon(":/Learn-English-Icon.png");
-    setWindowIcon(windowIcon);
+namespace {
+// Long enough for a slow first attempt at a long word.
+const int kRecordMs = 2000;
+const int kSearchResults = 8;
+}
 
-    QWidget* centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
+PracticeWindow::PracticeWindow(QWidget* parent)
+    : QWidget(parent), microphone(nullptr), currentIndex(0),
+      checkpoint(SessionCheckpoint::currentUserName()) {
+    ELA_TRACE_SCOPE("PracticeWindow::PracticeWindow");
+    setWindowTitle("תרגול אנגלית");
 
-    QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(0, 0, 0, 0);
 
-    QLabel* imageLabel = new QLabel(centralWidget);
+    QLabel* imageLabel = new QLabel(this);
     imageLabel->setScaledContents(true);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-    QPixmap pixmap(":/Learn-English.png");
-    QImage image = pixmap.toImage();
-    QImage transparentImage(image.size(), QImage::Format_ARGB32);
-    transparentImage.fill(Qt::transparent);
-    QPainter painter(&transparentImage);
-    painter.setOpacity(0.6);
-    painter.drawImage(0, 0, image);
-    painter.end();
-    QPixmap transparentPixmap = QPixmap::fromImage(transparentImage);
-    imageLabel->setPixmap(transparentPixmap.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    BackgroundCache::applyTo(imageLabel, 0.6, QSize(600, 400));
     imageLabel->setFixedSize(600, 400);
     imageLabel->setGeometry(0, 0, 600, 400);
     imageLabel->lower();
 
-    QWidget* contentWidget = new QWidget(centralWidget);
-    contentWidget->setStyleSheet("background: transparent;");
+    QWidget* contentWidget = new QWidget(this);
+    AppStyle::setRole(contentWidget, "content");
     QVBoxLayout* contentLayout = new QVBoxLayout(contentWidget);
     contentLayout->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter); 
 
-    QString wordBoxStyle =
-        "QLabel {"
-        "   background-color: #ebbf00;" 
-        "   color: black;"
-        "   font-size: 24px;" 
-        "   padding: 10px;"
-        "   border-radius: 8px;" 
-        "   font-weight: bold;"
-        "}";
+    searchEdit = new QLineEdit(this);
+    AppStyle::setRole(searchEdit, "answer");
+    searchEdit->setPlaceholderText("חפש מילה: English, עברית או ivrit");
+    searchEdit->setClearButtonEnabled(true);
+    contentLayout->addWidget(searchEdit);
+
+    searchResults = new QListWidget(this);
+    AppStyle::setRole(searchResults, "results");
+    searchResults->setMaximumHeight(120);
+    searchResults->hide();
+    contentLayout->addWidget(searchResults);
 
     englishWordLabel = new QLabel("מילה באנגלית", this);
-    englishWordLabel->setStyleSheet(wordBoxStyle);
+    AppStyle::setRole(englishWordLabel, "word");
     englishWordLabel->setAlignment(Qt::AlignCenter);
     englishWordLabel->setFixedSize(300, 60); 
     contentLayout->addWidget(englishWordLabel, 0, Qt::AlignHCenter); 
 
     hebrewTranslationLabel = new QLabel("תרגום לעברית", this);
-    hebrewTranslationLabel->setStyleSheet(wordBoxStyle);
+    AppStyle::setRole(hebrewTranslationLabel, "word");
     hebrewTranslationLabel->setAlignment(Qt::AlignCenter);
     hebrewTranslationLabel->setFixedSize(300, 60);
     contentLayout->addWidget(hebrewTranslationLabel, 0, Qt::AlignHCenter); 
 
     playSoundButton = new QPushButton("🔊 השמע שוב", this);
+    playExampleButton = new QPushButton("🔊 השמע דוגמא", this);
     nextButton = new QPushButton("הבא", this);
     prevButton = new QPushButton("קודם", this);
     backButton = new QPushButton("חזרה", this);
+    recordButton = new QPushButton("🎤 אמור את המילה", this);
 
-    QString buttonStyle =
-        "QPushButton {"
-        "   background-color: #ebbf00;"
-        "   color: black;" 
-        "   font-size: 16px;"
-        "   padding: 10px;"
-        "   border-radius: 8px;" 
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f5d33f;" 
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #ebbf00;" 
-        "}";
-
-    playSoundButton->setStyleSheet(buttonStyle);
-    nextButton->setStyleSheet(buttonStyle);
-    prevButton->setStyleSheet(buttonStyle);
-    backButton->setStyleSheet(buttonStyle);
+    for (QPushButton* button : { playSoundButton, playExampleButton, nextButton, prevButton, backButton, recordButton }) {
+        AppStyle::setRole(button, "gold");
+    }
 
     QHBoxLayout* buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(backButton);
     buttonLayout->addWidget(prevButton);
     buttonLayout->addWidget(nextButton);
     buttonLayout->addWidget(playSoundButton);
+    buttonLayout->addWidget(playExampleButton);
 
     contentLayout->addLayout(buttonLayout);
+    contentLayout->addWidget(recordButton, 0, Qt::AlignHCenter);
+
+    scoreLabel = new QLabel(this);
+    AppStyle::setRole(scoreLabel, "example");
+    scoreLabel->setAlignment(Qt::AlignCenter);
+    contentLayout->addWidget(scoreLabel);
 
     exampleEnLabel = new QLabel(this);
     exampleHeLabel = new QLabel(this);
     
-    QString exampleStyle =
-        "QLabel {"
-        "   background-color: rgba(235, 191, 0, 0.7);"
-        "   color: black;"
-        "   font-size: 16px;"
-        "   padding: 10px;"
-        "   border-radius: 8px;"
-        "   margin: 5px;"
-        "}";
-    
-    exampleEnLabel->setStyleSheet(exampleStyle);
-    exampleHeLabel->setStyleSheet(exampleStyle);
+    AppStyle::setRole(exampleEnLabel, "example");
+    AppStyle::setRole(exampleHeLabel, "example");
     
     contentLayout->addWidget(exampleEnLabel);
     contentLayout->addWidget(exampleHeLabel);
 
     mainLayout->addWidget(contentWidget);
 
-    resize(600, 400);
-
-    QScreen* screen = QGuiApplication::primaryScreen();
-    if (screen) {
-        QRect screenGeometry = screen->geometry();
-        int x = (screenGeometry.width() - this->width()) / 2;
-        int y = (screenGeometry.height() - this->height()) / 2;
-        this->move(x, y);
-    }
-
     connect(nextButton, &QPushButton::clicked, this, &PracticeWindow::nextWord);
     connect(prevButton, &QPushButton::clicked, this, &PracticeWindow::prevWord);
     connect(playSoundButton, &QPushButton::clicked, this, &PracticeWindow::playSound);
+    connect(playExampleButton, &QPushButton::clicked, this, &PracticeWindow::playExample);
     connect(backButton, &QPushButton::clicked, this, &PracticeWindow::goBack);
+    connect(recordButton, &QPushButton::clicked, this, &PracticeWindow::recordAnswer);
+    connect(searchEdit, &QLineEdit::textChanged, this, &PracticeWindow::updateSearch);
+    connect(searchEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (searchResults->count() > 0) {
+            openSearchResult(searchResults->item(0));
+        }
+    });
+    connect(searchResults, &QListWidget::itemClicked, this, &PracticeWindow::openSearchResult);
+}
+
+PracticeWindow::~PracticeWindow() {}
 
-    loadWords(jsonFile);
+void PracticeWindow::start(const QString& jsonFile) {
+    openLevel(jsonFile);
+    currentIndex = qBound(0, ProgressSync::registerValue(positionRegister(), 0).toInt(), int(englishWords.size()) - 1);
     updateDisplay();
-    playSound();
+    beginCheckpoint();
+    playSoundLater();
 }
 
-PracticeWindow::~PracticeWindow() {}
+void PracticeWindow::openLevel(const QString& jsonFile) {
+    if (jsonFile != this->jsonFile || englishWords.isEmpty()) {
+        this->jsonFile = jsonFile;
+        loadWords(jsonFile);
+    }
+    currentIndex = 0;
+}
+
+void PracticeWindow::restoreSession(const SessionState& state) {
+    openLevel(state.level);
+    if (state.position >= 0 && state.position < englishWords.size()) {
+        currentIndex = state.position;
+    }
+    updateDisplay();
+    beginCheckpoint();
+    playSoundLater();
+}
+
+QString PracticeWindow::positionRegister() const {
+    return QString("practicePositionLevel%1").arg(ProgressLog::levelFromFile(jsonFile));
+}
+
+void PracticeWindow::beginCheckpoint() {
+    SessionState state;
+    state.gameMode = "Practice";
+    state.level = jsonFile;
+    state.position = currentIndex;
+    checkpoint.begin(state);
+}
 
 void PracticeWindow::loadWords(const QString& jsonFile) {
+    ELA_TRACE_SCOPE("PracticeWindow::loadWords");
     QString fileName = jsonFile;
     fileName.replace(".json", "_enhanced.json");
     QString filePath = QString("resources/%1").arg(fileName);
@@ -177,6 +195,12 @@ void PracticeWindow::loadWords(const QString& jsonFile) {
         }
     }
     file.close();
+
+    QStringList hebrewWords;
+    for (const QString& englishWord : englishWords) {
+        hebrewWords.append(wordsMap.value(englishWord));
+    }
+    headwordIndex.build(englishWords, hebrewWords);
 }
 
 void PracticeWindow::updateDisplay() {
@@ -189,6 +213,7 @@ void PracticeWindow::updateDisplay() {
     // הצגת המילים
     englishWordLabel->setText(englishWord);
     hebrewTranslationLabel->setText(hebrewWord);
+    scoreLabel->clear();
 
     // הצגת הדוגמאות
     if (examplesMap.contains(englishWord)) {
@@ -196,11 +221,14 @@ void PracticeWindow::updateDisplay() {
         exampleEnLabel->setText(examples.first);
         exampleHeLabel->setText(examples.second);
     }
+    playExampleButton->setEnabled(!examplesMap.value(englishWord).first.isEmpty());
 }
 
 void PracticeWindow::nextWord() {
     if (currentIndex < englishWords.size() - 1) {
         currentIndex++;
+        checkpoint.recordPosition(currentIndex);
+        ProgressSync::setRegister(positionRegister(), currentIndex);
         updateDisplay();
         playSound();
     }
@@ -212,6 +240,8 @@ void PracticeWindow::nextWord() {
 void PracticeWindow::prevWord() {
     if (currentIndex > 0) {
         currentIndex--;
+        checkpoint.recordPosition(currentIndex);
+        ProgressSync::setRegister(positionRegister(), currentIndex);
         updateDisplay();
         playSound();
     }
@@ -220,20 +250,120 @@ void PracticeWindow::prevWord() {
     }
 }
 
+void PracticeWindow::jumpTo(int index) {
+    if (index < 0 || index >= englishWords.size()) {
+        return;
+    }
+    currentIndex = index;
+    checkpoint.recordPosition(currentIndex);
+    ProgressSync::setRegister(positionRegister(), currentIndex);
+    updateDisplay();
+    playSound();
+}
+
+void PracticeWindow::updateSearch() {
+    searchResults->clear();
+    const QList<int> found = headwordIndex.find(searchEdit->text(), kSearchResults);
+    for (int index : found) {
+        const QString& englishWord = englishWords.at(index);
+        QListWidgetItem* item = new QListWidgetItem(QString("%1 - %2").arg(englishWord, wordsMap.value(englishWord)), searchResults);
+        item->setData(Qt::UserRole, index);
+    }
+    searchResults->setVisible(!found.isEmpty());
+}
+
+void PracticeWindow::openSearchResult(QListWidgetItem* item) {
+    jumpTo(item->data(Qt::UserRole).toInt());
+    // Clearing the box deletes the list items, so not while one is being clicked.
+    QTimer::singleShot(0, searchEdit, &QLineEdit::clear);
+}
+
+void PracticeWindow::playSoundLater() {
+    // Lets the page paint before speech starts.
+    QTimer::singleShot(0, this, [this]() {
+        if (isVisible()) {
+            playSound();
+        }
+    });
+}
+
 void PracticeWindow::playSound() {
     QString wordToSpeak = englishWordLabel->text();
     if (!wordToSpeak.isEmpty()) {
-        textToSpeech->setLocale(QLocale(QLocale::English, QLocale::UnitedStates));
-        textToSpeech->say(wordToSpeak);
+        QLocale english(QLocale::English, QLocale::UnitedStates);
+        SpeechService& speech = SpeechService::instance();
+        speech.speak(wordToSpeak, english);
+        // "Next" is by far the most common step, so its word is made ready now.
+        if (currentIndex + 1 < englishWords.size()) {
+            speech.prefetch(englishWords.at(currentIndex + 1), english);
+        }
     }
     else {
         qDebug() << "No word to speak.";
     }
 }
 
-void PracticeWindow::goBack() {
-    if (parentWidget()) {
-        parentWidget()->show();
+void PracticeWindow::playExample() {
+    // Queued behind the word if it is still being read, and dropped if the
+    // learner moves on first.
+    QString example = examplesMap.value(englishWordLabel->text()).first;
+    if (!example.isEmpty()) {
+        SpeechService::instance().speak(example, QLocale(QLocale::English, QLocale::UnitedStates),
+                                        QVoice(), SpeechService::Example);
     }
-    this->close();
+}
+
+void PracticeWindow::recordAnswer() {
+    QString word = englishWordLabel->text();
+    if (microphone || word.isEmpty()) {
+        return;
+    }
+    QAudioDevice device = QMediaDevices::defaultAudioInput();
+    if (device.isNull()) {
+        scoreLabel->setText("לא נמצא מיקרופון");
+        return;
+    }
+    // The speaker must not end up in the recording.
+    SpeechService::instance().stop();
+
+    QAudioFormat format;
+    format.setSampleRate(PronunciationScorer::kSampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+    if (!device.isFormatSupported(format)) {
+        format = device.preferredFormat();
+    }
+    microphone = new QAudioSource(device, format, this);
+    recording.close();
+    recording.setData(QByteArray());
+    recording.open(QIODevice::WriteOnly);
+    microphone->start(&recording);
+    recordButton->setEnabled(false);
+    scoreLabel->setText("מקליט... אמור את המילה");
+    QTimer::singleShot(kRecordMs, this, [this, word]() { scoreRecording(word); });
+}
+
+void PracticeWindow::scoreRecording(const QString& word) {
+    microphone->stop();
+    QAudioFormat format = microphone->format();
+    microphone->deleteLater();
+    microphone = nullptr;
+    recording.close();
+    recordButton->setEnabled(true);
+
+    // The word was spoken when it was shown, so its audio is normally cached.
+    SpeechCache::Clip reference;
+    if (!SpeechService::instance().findClip(word, QLocale(QLocale::English, QLocale::UnitedStates), reference)) {
+        scoreLabel->setText("אין הקלטת ייחוס למילה זו");
+        return;
+    }
+    int score = PronunciationScorer::score(PronunciationScorer::toMono(format, recording.data()),
+                                           PronunciationScorer::toMono(reference.format, reference.pcm));
+    scoreLabel->setText(QString("ציון הגייה: %1").arg(score));
+}
+
+void PracticeWindow::goBack() {
+    checkpoint.clear();
+    SpeechService::instance().stop();
+    emit finished();
 }
\ No newline at end of file
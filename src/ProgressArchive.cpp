@@ -0,0 +1,243 @@
+#include "ProgressArchive.h"
+#include "ProgressSync.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QDebug>
+#include <memory>
+
+namespace {
+const quint32 kArchiveMagic = 0x454C4158; // "ELAX"
+const quint16 kArchiveVersion = 2;
+
+enum ArchiveTag : quint8 {
+    EndTag = 0,
+    UserTag = 1,
+    ScoresTag = 2,      // version 1 only: plain totals
+    UsedWordsTag = 3,
+    EventsTag = 4,
+    CountersTag = 5
+};
+}
+
+ProgressArchive::ProgressArchive(QSettings& settings, const ProgressLog& log)
+    : settings(settings), log(log)
+{
+}
+
+QStringList ProgressArchive::users() const
+{
+    QStringList result = settings.childGroups();
+    for (const QString& user : log.users()) {
+        if (!result.contains(user)) {
+            result.append(user);
+        }
+    }
+    return result;
+}
+
+bool ProgressArchive::exportTo(const QString& filePath, QString* error)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kArchiveMagic << kArchiveVersion;
+
+    for (const QString& user : users()) {
+        out << quint8(UserTag) << user;
+
+        const QList<ProgressSync::Counter> counters = ProgressSync::counters(settings, user);
+        out << quint8(CountersTag) << quint32(counters.size());
+        for (const ProgressSync::Counter& counter : counters) {
+            out << counter.device << counter.game << counter.value;
+        }
+        out << quint8(UsedWordsTag) << settings.value(user + "/usedWords").toStringList();
+
+        log.read(user, [&out](const QList<AnswerEvent>& batch) {
+            out << quint8(EventsTag) << quint32(batch.size());
+            for (const AnswerEvent& event : batch) {
+                out << event;
+            }
+            return out.status() == QDataStream::Ok;
+        });
+    }
+    out << quint8(EndTag);
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ProgressArchive::importFrom(const QString& filePath, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kArchiveMagic || version < 1 || version > kArchiveVersion) {
+        if (error) *error = "Unsupported archive format";
+        return false;
+    }
+
+    // Each user's answers are merged into their log in timestamp order with
+    // exact duplicates dropped, so importing the same archive twice does not
+    // duplicate answers.
+    QString user;
+    std::unique_ptr<ProgressLog::Merge> merge;
+    auto finishMerge = [&]() {
+        bool ok = !merge || merge->finish();
+        merge.reset();
+        if (!ok && error) *error = QString("Could not merge the answers of %1").arg(user);
+        return ok;
+    };
+
+    while (true) {
+        quint8 tag = EndTag;
+        in >> tag;
+        if (in.status() != QDataStream::Ok) {
+            if (error) *error = "Truncated archive";
+            return false;
+        }
+
+        switch (tag) {
+        case EndTag:
+            return finishMerge();
+        case UserTag:
+            if (!finishMerge()) {
+                return false;
+            }
+            in >> user;
+            merge.reset(new ProgressLog::Merge(log, user));
+            break;
+        case ScoresTag: {
+            quint32 count = 0;
+            in >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                QString game;
+                qint32 score = 0;
+                in >> game >> score;
+                QString key = QString("%1/%2/score").arg(user).arg(game);
+                settings.setValue(key, qMax(settings.value(key, 0).toInt(), int(score)));
+            }
+            break;
+        }
+        case CountersTag: {
+            // Points stay with the device that earned them, so a later sync
+            // with that device does not count them again.
+            quint32 count = 0;
+            in >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                ProgressSync::Counter counter;
+                in >> counter.device >> counter.game >> counter.value;
+                if (in.status() == QDataStream::Ok) {
+                    ProgressSync::mergeCounter(settings, user, counter);
+                }
+            }
+            break;
+        }
+        case UsedWordsTag: {
+            QStringList words;
+            in >> words;
+            QString key = QString("%1/usedWords").arg(user);
+            QStringList usedWords = settings.value(key).toStringList();
+            for (const QString& word : words) {
+                if (!usedWords.contains(word)) {
+                    usedWords.append(word);
+                }
+            }
+            settings.setValue(key, usedWords);
+            break;
+        }
+        case EventsTag: {
+            quint32 count = 0;
+            in >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                AnswerEvent event;
+                in >> event;
+                if (in.status() == QDataStream::Ok && merge) {
+                    merge->add(event);
+                }
+            }
+            break;
+        }
+        default:
+            if (error) *error = QString("Unknown archive record %1").arg(tag);
+            return false;
+        }
+    }
+}
+
+void ProgressArchive::runBenchmark(int eventCount)
+{
+    QTemporaryDir dir;
+    const int userCount = 30;
+    const int eventsPerUser = qMax(1, eventCount / userCount);
+    const QStringList games = { "Hebrew", "English", "MemoryGame" };
+
+    QSettings sourceSettings(dir.filePath("source.ini"), QSettings::IniFormat);
+    ProgressLog sourceLog(dir.filePath("source"));
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (int u = 0; u < userCount; ++u) {
+        QString user = QString("student%1").arg(u);
+        sourceSettings.setValue(user + "/password", "secret");
+        for (const QString& game : games) {
+            sourceSettings.setValue(QString("%1/%2/score").arg(user).arg(game), eventsPerUser / 3);
+        }
+
+        QList<AnswerEvent> batch;
+        for (int i = 0; i < eventsPerUser; ++i) {
+            AnswerEvent event;
+            event.timestamp = now - qint64(eventsPerUser - i) * 1000;
+            event.game = games[i % games.size()];
+            event.level = 1 + i % 5;
+            event.word = QString("word%1").arg(i % 2000);
+            event.correct = (i % 4) != 0;
+            batch.append(event);
+            if (batch.size() == ProgressLog::kBatchSize) {
+                sourceLog.append(user, batch);
+                batch.clear();
+            }
+        }
+        sourceLog.append(user, batch);
+    }
+    sourceSettings.sync();
+
+    QString archivePath = dir.filePath("progress.elax");
+    QElapsedTimer timer;
+
+    timer.start();
+    ProgressArchive(sourceSettings, sourceLog).exportTo(archivePath);
+    qint64 exportMs = qMax<qint64>(1, timer.elapsed());
+
+    QSettings targetSettings(dir.filePath("target.ini"), QSettings::IniFormat);
+    ProgressLog targetLog(dir.filePath("target"));
+    timer.restart();
+    ProgressArchive(targetSettings, targetLog).importFrom(archivePath);
+    qint64 importMs = qMax<qint64>(1, timer.elapsed());
+
+    qint64 total = qint64(eventsPerUser) * userCount;
+    qInfo().noquote() << QString("progress archive: %1 events, export %2 ms (%3 events/s), "
+                                 "import %4 ms (%5 events/s), archive %6 bytes")
+                             .arg(total)
+                             .arg(exportMs).arg(total * 1000 / exportMs)
+                             .arg(importMs).arg(total * 1000 / importMs)
+                             .arg(QFileInfo(archivePath).size());
+}
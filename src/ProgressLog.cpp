@@ -0,0 +1,324 @@
+#include "ProgressLog.h"
+#include "ProgressStats.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+namespace {
+const quint32 kLogMagic = 0x454C414C; // "ELAL"
+const quint16 kLogVersion = 1;
+// Events buffered per run while merging.
+const int kMergeChunk = 256;
+// Bytes covered by digest().
+const qint64 kDigestBytes = 4096;
+}
+
+QDataStream& operator<<(QDataStream& out, const AnswerEvent& event)
+{
+    out << event.timestamp << event.game << quint8(event.level) << event.word << event.correct;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, AnswerEvent& event)
+{
+    quint8 level = 0;
+    in >> event.timestamp >> event.game >> level >> event.word >> event.correct;
+    event.level = level;
+    return in;
+}
+
+bool operator<(const AnswerEvent& a, const AnswerEvent& b)
+{
+    return std::tie(a.timestamp, a.game, a.level, a.word, a.correct)
+         < std::tie(b.timestamp, b.game, b.level, b.word, b.correct);
+}
+
+bool operator==(const AnswerEvent& a, const AnswerEvent& b)
+{
+    return a.timestamp == b.timestamp && a.game == b.game && a.level == b.level
+        && a.word == b.word && a.correct == b.correct;
+}
+
+ProgressLog::ProgressLog(const QString& directory)
+    : directory(directory)
+{
+    QDir().mkpath(directory);
+}
+
+QString ProgressLog::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/progress";
+}
+
+int ProgressLog::levelFromFile(const QString& dictionaryFile)
+{
+    static QRegularExpression levelRegex("level(\\d+)");
+    QRegularExpressionMatch match = levelRegex.match(dictionaryFile);
+    return match.hasMatch() ? match.captured(1).toInt() : 0;
+}
+
+void ProgressLog::record(const QString& game, const QString& dictionaryFile, const QString& word, bool correct)
+{
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    QString userName = settings.value("UserName", "").toString();
+    if (userName.isEmpty()) {
+        return;
+    }
+
+    AnswerEvent event;
+    event.timestamp = QDateTime::currentMSecsSinceEpoch();
+    event.game = game;
+    event.level = levelFromFile(dictionaryFile);
+    event.word = word;
+    event.correct = correct;
+
+    ProgressLog().append(userName, { event });
+    ProgressStats::instance().record(userName, event);
+}
+
+QString ProgressLog::pathFor(const QString& userName) const
+{
+    return directory + "/" + QString::fromLatin1(userName.toUtf8().toHex()) + ".log";
+}
+
+QStringList ProgressLog::users() const
+{
+    QStringList result;
+    const QStringList files = QDir(directory).entryList({ "*.log" }, QDir::Files);
+    for (const QString& file : files) {
+        result.append(QString::fromUtf8(QByteArray::fromHex(file.chopped(4).toLatin1())));
+    }
+    return result;
+}
+
+void ProgressLog::remove(const QString& userName) const
+{
+    QFile::remove(pathFor(userName));
+}
+
+bool ProgressLog::append(const QString& userName, const QList<AnswerEvent>& events) const
+{
+    QFile file(pathFor(userName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Could not open progress log:" << file.fileName();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    if (file.size() == 0) {
+        out << kLogMagic << kLogVersion;
+    }
+    for (const AnswerEvent& event : events) {
+        out << event;
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+bool ProgressLog::read(const QString& userName,
+                       const std::function<bool(const QList<AnswerEvent>&)>& onBatch,
+                       int batchSize, qint64 from) const
+{
+    QFile file(pathFor(userName));
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open progress log:" << file.fileName();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kLogMagic || version != kLogVersion) {
+        qWarning() << "Unknown progress log format:" << file.fileName();
+        return false;
+    }
+    if (from > file.pos()) {
+        file.seek(from);
+    }
+
+    QList<AnswerEvent> batch;
+    batch.reserve(batchSize);
+    bool intact = true;
+    while (!in.atEnd()) {
+        AnswerEvent event;
+        in >> event;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Damaged record in progress log:" << file.fileName() << "at" << file.pos();
+            intact = false;
+            break;
+        }
+        batch.append(event);
+        if (batch.size() == batchSize) {
+            if (!onBatch(batch)) {
+                return true;
+            }
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty()) {
+        onBatch(batch);
+    }
+    return intact;
+}
+
+qint64 ProgressLog::size(const QString& userName) const
+{
+    return QFileInfo(pathFor(userName)).size();
+}
+
+QByteArray ProgressLog::digest(const QString& userName, qint64 position) const
+{
+    QFile file(pathFor(userName));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < position) {
+        return QByteArray();
+    }
+    qint64 start = qMax<qint64>(0, position - kDigestBytes);
+    file.seek(start);
+    return QCryptographicHash::hash(file.read(position - start), QCryptographicHash::Sha1);
+}
+
+ProgressLog::Merge::Merge(const ProgressLog& log, const QString& userName)
+    : log(log)
+    , userName(userName)
+    , runs(log.directory + "/mergeXXXXXX")
+    , failed(false)
+{
+    pending.reserve(kBatchSize);
+}
+
+void ProgressLog::Merge::add(const AnswerEvent& event)
+{
+    pending.append(event);
+    if (pending.size() == kBatchSize) {
+        failed = !spill() || failed;
+    }
+}
+
+bool ProgressLog::Merge::spill()
+{
+    if (pending.isEmpty()) {
+        return true;
+    }
+    if (!runs.isOpen() && !runs.open()) {
+        qWarning() << "Could not create merge file in" << log.directory;
+        return false;
+    }
+    std::sort(pending.begin(), pending.end());
+    runs.seek(runs.size());
+    qint64 offset = runs.pos();
+    QDataStream out(&runs);
+    out.setVersion(QDataStream::Qt_6_0);
+    for (const AnswerEvent& event : pending) {
+        out << event;
+    }
+    runBounds.append(qMakePair(offset, qint64(pending.size())));
+    pending.clear();
+    return out.status() == QDataStream::Ok;
+}
+
+bool ProgressLog::Merge::finish()
+{
+    // The old log goes through the same runs, so it need not be in order.
+    // A log that cannot be read in full is left alone rather than replaced
+    // by what could be read of it.
+    bool readOk = log.read(userName, [this](const QList<AnswerEvent>& batch) {
+        for (const AnswerEvent& event : batch) {
+            add(event);
+        }
+        return !failed;
+    });
+    if (!readOk) {
+        qWarning() << "Not merging into unreadable progress log of" << userName;
+        return false;
+    }
+    if (!spill() || failed) {
+        return false;
+    }
+    if (runBounds.isEmpty()) {
+        return true;
+    }
+
+    struct Cursor
+    {
+        qint64 offset;
+        qint64 remaining;
+        QList<AnswerEvent> buffer;
+        int index;
+    };
+    QList<Cursor> cursors;
+    auto refill = [this](Cursor& cursor) {
+        cursor.buffer.clear();
+        cursor.index = 0;
+        runs.seek(cursor.offset);
+        QDataStream in(&runs);
+        in.setVersion(QDataStream::Qt_6_0);
+        for (int i = 0; i < kMergeChunk && cursor.remaining > 0; ++i, --cursor.remaining) {
+            AnswerEvent event;
+            in >> event;
+            cursor.buffer.append(event);
+        }
+        cursor.offset = runs.pos();
+        return in.status() == QDataStream::Ok;
+    };
+    for (const auto& bounds : runBounds) {
+        cursors.append(Cursor { bounds.first, bounds.second, {}, 0 });
+        if (!refill(cursors.last())) {
+            return false;
+        }
+    }
+
+    auto later = [&cursors](int a, int b) {
+        return cursors[b].buffer[cursors[b].index] < cursors[a].buffer[cursors[a].index];
+    };
+    std::priority_queue<int, std::vector<int>, decltype(later)> heads(later);
+    for (int i = 0; i < cursors.size(); ++i) {
+        heads.push(i);
+    }
+
+    QSaveFile file(log.pathFor(userName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not rewrite progress log:" << file.fileName();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kLogMagic << kLogVersion;
+    AnswerEvent last;
+    bool first = true;
+    while (!heads.empty()) {
+        int i = heads.top();
+        heads.pop();
+        Cursor& cursor = cursors[i];
+        const AnswerEvent& event = cursor.buffer[cursor.index];
+        if (first || !(event == last)) {
+            out << event;
+            last = event;
+            first = false;
+        }
+        if (++cursor.index == cursor.buffer.size()) {
+            if (cursor.remaining == 0) {
+                continue;
+            }
+            if (!refill(cursor)) {
+                return false;
+            }
+        }
+        heads.push(i);
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
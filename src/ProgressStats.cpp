@@ -0,0 +1,331 @@
+#include "ProgressStats.h"
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+const quint32 kStatsMagic = 0x454C4154; // "ELAT"
+const quint16 kStatsVersion = 2;
+}
+
+ProgressStats& ProgressStats::instance()
+{
+    static ProgressStats stats;
+    return stats;
+}
+
+ProgressStats::ProgressStats()
+    : dirty(false)
+{
+    ELA_TRACE_SCOPE("ProgressStats load");
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    path = dir + "/stats.dat";
+
+    // First run after an update: derive the aggregates from the history once.
+    if (!load() || !catchUp()) {
+        rebuild();
+    }
+}
+
+ProgressStats::~ProgressStats()
+{
+    flush();
+}
+
+void ProgressStats::record(const QString& user, const AnswerEvent& event)
+{
+    apply(user, event);
+    markDirty();
+}
+
+void ProgressStats::raiseScore(const QString& user, const QString& game, int score)
+{
+    if (score > boardScore(game, 0, user)) {
+        setBoardScore(game, 0, user, score);
+        markDirty();
+    }
+}
+
+void ProgressStats::flush()
+{
+    if (dirty) {
+        save();
+    }
+}
+
+void ProgressStats::markDirty()
+{
+    if (dirty) {
+        return;
+    }
+    dirty = true;
+
+    QCoreApplication* app = QCoreApplication::instance();
+    if (app) {
+        QTimer::singleShot(kSaveDelayMs, app, [this]() { flush(); });
+    } else {
+        flush();
+    }
+}
+
+void ProgressStats::apply(const QString& user, const AnswerEvent& event)
+{
+    if (event.correct) {
+        addToBoard(event.game, event.level, user);
+        addToBoard(event.game, 0, user);
+    }
+
+    UserStats& stats = users[user];
+
+    qint64 day = QDateTime::fromMSecsSinceEpoch(event.timestamp).date().toJulianDay();
+    if (stats.currentStreak == 0 || day == stats.lastDay + 1) {
+        stats.currentStreak++;
+        stats.lastDay = day;
+    } else if (day > stats.lastDay + 1) {
+        stats.currentStreak = 1;
+        stats.lastDay = day;
+    }
+    stats.bestStreak = qMax(stats.bestStreak, stats.currentStreak);
+
+    quint64 bit = quint64(1) << stats.recentPos;
+    if (stats.recentCount == kAccuracyWindow) {
+        if (stats.recentBits & bit) {
+            stats.recentCorrect--;
+        }
+    } else {
+        stats.recentCount++;
+    }
+    if (event.correct) {
+        stats.recentBits |= bit;
+        stats.recentCorrect++;
+    } else {
+        stats.recentBits &= ~bit;
+    }
+    stats.recentPos = (stats.recentPos + 1) % kAccuracyWindow;
+}
+
+void ProgressStats::addToBoard(const QString& game, int level, const QString& user)
+{
+    setBoardScore(game, level, user, boardScore(game, level, user) + 1);
+}
+
+int ProgressStats::boardScore(const QString& game, int level, const QString& user) const
+{
+    auto board = boards.constFind(qMakePair(game, level));
+    return board == boards.constEnd() ? 0 : board->scores.value(user);
+}
+
+void ProgressStats::setBoardScore(const QString& game, int level, const QString& user, int score)
+{
+    Board& board = boards[qMakePair(game, level)];
+    int& current = board.scores[user];
+    board.ranking.erase(std::make_pair(current, user));
+    current = score;
+    board.ranking.insert(std::make_pair(current, user));
+}
+
+void ProgressStats::removeUser(const QString& user)
+{
+    for (Board& board : boards) {
+        auto it = board.scores.find(user);
+        if (it != board.scores.end()) {
+            board.ranking.erase(std::make_pair(it.value(), user));
+            board.scores.erase(it);
+        }
+    }
+    users.remove(user);
+    save();
+}
+
+bool ProgressStats::catchUp()
+{
+    ProgressLog log;
+    bool replayed = false;
+    for (const QString& user : log.users()) {
+        QPair<qint64, QByteArray> position = logPositions.value(user);
+        if (position.first > 0 && log.digest(user, position.first) != position.second) {
+            return false;
+        }
+        if (log.size(user) == position.first) {
+            continue;
+        }
+        log.read(user, [this, &user](const QList<AnswerEvent>& batch) {
+            for (const AnswerEvent& event : batch) {
+                apply(user, event);
+            }
+            return true;
+        }, ProgressLog::kBatchSize, position.first);
+        replayed = true;
+    }
+    if (replayed) {
+        markDirty();
+    }
+    return true;
+}
+
+void ProgressStats::rebuild()
+{
+    boards.clear();
+    users.clear();
+
+    ProgressLog log;
+    for (const QString& user : log.users()) {
+        log.read(user, [this, &user](const QList<AnswerEvent>& batch) {
+            for (const AnswerEvent& event : batch) {
+                apply(user, event);
+            }
+            return true;
+        });
+    }
+
+    // Totals saved before the log existed are not in it.
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    for (const QString& key : settings.allKeys()) {
+        QStringList parts = key.split('/');
+        if (parts.size() == 3 && parts[2] == "score") {
+            int score = settings.value(key).toInt();
+            if (score > boardScore(parts[1], 0, parts[0])) {
+                setBoardScore(parts[1], 0, parts[0], score);
+            }
+        }
+    }
+    save();
+}
+
+QList<ProgressStats::Entry> ProgressStats::top(const QString& game, int level, int count) const
+{
+    QList<Entry> result;
+    auto board = boards.constFind(qMakePair(game, level));
+    if (board == boards.constEnd()) {
+        return result;
+    }
+    for (auto it = board->ranking.begin(); it != board->ranking.end() && result.size() < count; ++it) {
+        result.append({ it->second, it->first });
+    }
+    return result;
+}
+
+int ProgressStats::currentStreak(const QString& user) const
+{
+    UserStats stats = users.value(user);
+    qint64 today = QDate::currentDate().toJulianDay();
+    return stats.lastDay >= today - 1 ? stats.currentStreak : 0;
+}
+
+int ProgressStats::bestStreak(const QString& user) const
+{
+    return users.value(user).bestStreak;
+}
+
+int ProgressStats::recentAnswers(const QString& user) const
+{
+    return users.value(user).recentCount;
+}
+
+int ProgressStats::recentCorrect(const QString& user) const
+{
+    return users.value(user).recentCorrect;
+}
+
+bool ProgressStats::load()
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kStatsMagic || version != kStatsVersion) {
+        return false;
+    }
+
+    quint32 boardCount = 0;
+    in >> boardCount;
+    for (quint32 i = 0; i < boardCount && in.status() == QDataStream::Ok; ++i) {
+        QString game;
+        qint32 level = 0;
+        QHash<QString, int> scores;
+        in >> game >> level >> scores;
+        Board& board = boards[qMakePair(game, int(level))];
+        board.scores = scores;
+        for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+            board.ranking.insert(std::make_pair(it.value(), it.key()));
+        }
+    }
+
+    quint32 userCount = 0;
+    in >> userCount;
+    for (quint32 i = 0; i < userCount && in.status() == QDataStream::Ok; ++i) {
+        QString user;
+        qint32 currentStreak = 0, bestStreak = 0, recentPos = 0, recentCount = 0, recentCorrect = 0;
+        UserStats stats;
+        in >> user >> stats.lastDay >> currentStreak >> bestStreak
+           >> stats.recentBits >> recentPos >> recentCount >> recentCorrect;
+        stats.currentStreak = currentStreak;
+        stats.bestStreak = bestStreak;
+        stats.recentPos = recentPos;
+        stats.recentCount = recentCount;
+        stats.recentCorrect = recentCorrect;
+        users.insert(user, stats);
+    }
+
+    in >> logPositions;
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Corrupt statistics file, rebuilding:" << path;
+        boards.clear();
+        users.clear();
+        logPositions.clear();
+        return false;
+    }
+    return true;
+}
+
+void ProgressStats::save()
+{
+    dirty = false;
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write statistics:" << path;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kStatsMagic << kStatsVersion;
+
+    out << quint32(boards.size());
+    for (auto it = boards.constBegin(); it != boards.constEnd(); ++it) {
+        out << it.key().first << qint32(it.key().second) << it.value().scores;
+    }
+
+    out << quint32(users.size());
+    for (auto it = users.constBegin(); it != users.constEnd(); ++it) {
+        const UserStats& stats = it.value();
+        out << it.key() << stats.lastDay << qint32(stats.currentStreak) << qint32(stats.bestStreak)
+            << stats.recentBits << qint32(stats.recentPos) << qint32(stats.recentCount) << qint32(stats.recentCorrect);
+    }
+
+    ProgressLog log;
+    logPositions.clear();
+    for (const QString& user : log.users()) {
+        qint64 size = log.size(user);
+        logPositions.insert(user, qMakePair(size, log.digest(user, size)));
+    }
+    out << logPositions;
+
+    file.commit();
+}
@@ -0,0 +1,363 @@
+#include "ProgressSync.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QDebug>
+#include <memory>
+
+namespace {
+const quint32 kStateMagic = 0x454C4144; // "ELAD"
+const quint16 kStateVersion = 1;
+
+enum StateTag : quint8 {
+    EndTag = 0,
+    UserTag = 1,
+    CountersTag = 2,
+    UsedWordsTag = 3,
+    RegistersTag = 4,
+    EventsTag = 5
+};
+
+QString currentUser()
+{
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    return settings.value("UserName", "").toString();
+}
+
+// Scores saved before this device kept its own counter become its starting
+// count, once: whatever the known remote counters leave over.
+void seedOwnCounter(QSettings& settings, const QString& user, const QString& game, const QString& device)
+{
+    QString counterKey = QString("%1/sync/%2/%3").arg(user).arg(device).arg(game);
+    if (settings.contains(counterKey)) {
+        return;
+    }
+    qint64 remoteTotal = 0;
+    settings.beginGroup(user + "/sync");
+    for (const QString& remote : settings.childGroups()) {
+        if (remote != device) {
+            remoteTotal += settings.value(remote + "/" + game, 0).toLongLong();
+        }
+    }
+    settings.endGroup();
+    qint64 total = settings.value(QString("%1/%2/score").arg(user).arg(game), 0).toLongLong();
+    settings.setValue(counterKey, qMax<qint64>(0, total - remoteTotal));
+}
+}
+
+ProgressSync::ProgressSync(QSettings& settings, const ProgressLog& log)
+    : settings(settings), log(log), device(deviceId(settings))
+{
+}
+
+QString ProgressSync::deviceId(QSettings& settings)
+{
+    QString id = settings.value("DeviceId").toString();
+    if (id.isEmpty()) {
+        id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        settings.setValue("DeviceId", id);
+    }
+    return id;
+}
+
+void ProgressSync::addScore(QSettings& settings, const QString& user, const QString& game, qint64 points)
+{
+    if (user.isEmpty() || points <= 0) {
+        return;
+    }
+    QString device = deviceId(settings);
+    seedOwnCounter(settings, user, game, device);
+    QString scoreKey = QString("%1/%2/score").arg(user).arg(game);
+    QString counterKey = QString("%1/sync/%2/%3").arg(user).arg(device).arg(game);
+    settings.setValue(scoreKey, settings.value(scoreKey, 0).toLongLong() + points);
+    settings.setValue(counterKey, settings.value(counterKey, 0).toLongLong() + points);
+}
+
+QList<ProgressSync::Counter> ProgressSync::counters(QSettings& settings, const QString& user)
+{
+    QString device = deviceId(settings);
+    for (const QString& game : games(settings, user)) {
+        seedOwnCounter(settings, user, game, device);
+    }
+
+    QList<Counter> result;
+    settings.beginGroup(user + "/sync");
+    for (const QString& counterDevice : settings.childGroups()) {
+        settings.beginGroup(counterDevice);
+        for (const QString& game : settings.childKeys()) {
+            result.append({ counterDevice, game, settings.value(game).toLongLong() });
+        }
+        settings.endGroup();
+    }
+    settings.endGroup();
+    return result;
+}
+
+void ProgressSync::mergeCounter(QSettings& settings, const QString& user, const Counter& counter)
+{
+    // Seeded first, so merged points are not taken for old local ones.
+    seedOwnCounter(settings, user, counter.game, deviceId(settings));
+    QString counterKey = QString("%1/sync/%2/%3").arg(user).arg(counter.device).arg(counter.game);
+    qint64 knownValue = settings.value(counterKey, 0).toLongLong();
+    if (counter.value > knownValue) {
+        QString scoreKey = QString("%1/%2/score").arg(user).arg(counter.game);
+        settings.setValue(scoreKey, settings.value(scoreKey, 0).toLongLong() + counter.value - knownValue);
+        settings.setValue(counterKey, counter.value);
+    }
+}
+
+void ProgressSync::setRegister(const QString& name, const QVariant& value)
+{
+    QString user = currentUser();
+    if (user.isEmpty()) {
+        return;
+    }
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    QVariantList entry = { QDateTime::currentMSecsSinceEpoch(), deviceId(settings), value };
+    settings.setValue(QString("%1/registers/%2").arg(user).arg(name), entry);
+}
+
+QVariant ProgressSync::registerValue(const QString& name, const QVariant& defaultValue)
+{
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    QVariantList entry = settings.value(QString("%1/registers/%2").arg(currentUser()).arg(name)).toList();
+    return entry.size() == 3 ? entry[2] : defaultValue;
+}
+
+QStringList ProgressSync::users() const
+{
+    QStringList result = settings.childGroups();
+    for (const QString& user : log.users()) {
+        if (!result.contains(user)) {
+            result.append(user);
+        }
+    }
+    return result;
+}
+
+QStringList ProgressSync::games(QSettings& settings, const QString& user)
+{
+    QStringList result;
+    settings.beginGroup(user);
+    for (const QString& game : settings.childGroups()) {
+        if (settings.contains(game + "/score")) {
+            result.append(game);
+        }
+    }
+    settings.endGroup();
+    return result;
+}
+
+bool ProgressSync::exportState(const QString& filePath, QString* error)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kStateMagic << kStateVersion << device;
+
+    for (const QString& user : users()) {
+        out << quint8(UserTag) << user;
+
+        const QList<Counter> userCounters = counters(settings, user);
+        out << quint8(CountersTag) << quint32(userCounters.size());
+        for (const Counter& counter : userCounters) {
+            out << counter.device << counter.game << counter.value;
+        }
+
+        out << quint8(UsedWordsTag) << settings.value(user + "/usedWords").toStringList();
+
+        settings.beginGroup(user + "/registers");
+        const QStringList registerNames = settings.childKeys();
+        out << quint8(RegistersTag) << quint32(registerNames.size());
+        for (const QString& name : registerNames) {
+            out << name << settings.value(name).toList();
+        }
+        settings.endGroup();
+
+        log.read(user, [&out](const QList<AnswerEvent>& batch) {
+            out << quint8(EventsTag) << quint32(batch.size());
+            for (const AnswerEvent& event : batch) {
+                out << event;
+            }
+            return out.status() == QDataStream::Ok;
+        });
+    }
+    out << quint8(EndTag);
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ProgressSync::mergeState(const QString& filePath, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString remoteDevice;
+    in >> magic >> version >> remoteDevice;
+    if (magic != kStateMagic || version != kStateVersion) {
+        if (error) *error = "Unsupported device state format";
+        return false;
+    }
+
+    QString user;
+    std::unique_ptr<ProgressLog::Merge> merge;
+    auto finishMerge = [&]() {
+        bool ok = !merge || merge->finish();
+        merge.reset();
+        if (!ok && error) *error = QString("Could not merge the answers of %1").arg(user);
+        return ok;
+    };
+
+    while (true) {
+        quint8 tag = EndTag;
+        in >> tag;
+        if (in.status() != QDataStream::Ok) {
+            if (error) *error = "Truncated device state";
+            return false;
+        }
+
+        switch (tag) {
+        case EndTag:
+            return finishMerge();
+        case UserTag:
+            if (!finishMerge()) {
+                return false;
+            }
+            in >> user;
+            merge.reset(new ProgressLog::Merge(log, user));
+            break;
+        case CountersTag: {
+            quint32 count = 0;
+            in >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                Counter counter;
+                in >> counter.device >> counter.game >> counter.value;
+                if (in.status() == QDataStream::Ok) {
+                    mergeCounter(settings, user, counter);
+                }
+            }
+            break;
+        }
+        case UsedWordsTag: {
+            QStringList words;
+            in >> words;
+            QString key = QString("%1/usedWords").arg(user);
+            QStringList usedWords = settings.value(key).toStringList();
+            QSet<QString> present(usedWords.begin(), usedWords.end());
+            for (const QString& word : words) {
+                if (!present.contains(word)) {
+                    present.insert(word);
+                    usedWords.append(word);
+                }
+            }
+            settings.setValue(key, usedWords);
+            break;
+        }
+        case RegistersTag: {
+            quint32 count = 0;
+            in >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                QString name;
+                QVariantList remote;
+                in >> name >> remote;
+                if (remote.size() != 3) {
+                    continue;
+                }
+                QString key = QString("%1/registers/%2").arg(user).arg(name);
+                QVariantList local = settings.value(key).toList();
+                bool newer = local.size() != 3
+                    || remote[0].toLongLong() > local[0].toLongLong()
+                    || (remote[0].toLongLong() == local[0].toLongLong() && remote[1].toString() > local[1].toString());
+                if (newer) {
+                    settings.setValue(key, remote);
+                }
+            }
+            break;
+        }
+        case EventsTag: {
+            quint32 count = 0;
+            in >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                AnswerEvent event;
+                in >> event;
+                if (in.status() == QDataStream::Ok && merge) {
+                    merge->add(event);
+                }
+            }
+            break;
+        }
+        default:
+            if (error) *error = QString("Unknown device state record %1").arg(tag);
+            return false;
+        }
+    }
+}
+
+void ProgressSync::runBenchmark(int eventCount)
+{
+    QTemporaryDir dir;
+    const QString user = "student";
+    const QStringList games = { "Hebrew", "English", "MemoryGame" };
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QSettings labSettings(dir.filePath("lab.ini"), QSettings::IniFormat);
+    QSettings phoneSettings(dir.filePath("phone.ini"), QSettings::IniFormat);
+    ProgressLog labLog(dir.filePath("lab"));
+    ProgressLog phoneLog(dir.filePath("phone"));
+
+    // Two devices sharing the first half of their history, as after an earlier sync.
+    auto fillDevice = [&](QSettings& settings, const ProgressLog& log, int offset) {
+        QList<AnswerEvent> batch;
+        for (int i = 0; i < eventCount; ++i) {
+            int n = i < eventCount / 2 ? i : i + offset;
+            AnswerEvent event;
+            event.timestamp = now - qint64(eventCount * 2 - n) * 1000;
+            event.game = games[n % games.size()];
+            event.level = 1 + n % 5;
+            event.word = QString("word%1").arg(n % 2000);
+            event.correct = (n % 4) != 0;
+            batch.append(event);
+            if (batch.size() == ProgressLog::kBatchSize) {
+                log.append(user, batch);
+                batch.clear();
+            }
+        }
+        log.append(user, batch);
+        for (const QString& game : games) {
+            settings.setValue(QString("%1/%2/score").arg(user).arg(game), eventCount / 3);
+        }
+    };
+    fillDevice(labSettings, labLog, 0);
+    fillDevice(phoneSettings, phoneLog, eventCount);
+
+    QString statePath = dir.filePath("phone.elad");
+    ProgressSync(phoneSettings, phoneLog).exportState(statePath);
+
+    QElapsedTimer timer;
+    timer.start();
+    ProgressSync(labSettings, labLog).mergeState(statePath);
+    qint64 mergeMs = timer.elapsed();
+
+    qInfo().noquote() << QString("progress sync: merged %1 events into %2 local events in %3 ms")
+                             .arg(eventCount).arg(eventCount).arg(mergeMs);
+}
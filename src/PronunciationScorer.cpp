@@ -0,0 +1,390 @@
+#include "PronunciationScorer.h"
+#include "SoundBank.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int kFrameLength = 400;   // 25 ms
+const int kFrameStep = 160;     // 10 ms
+const int kFftSize = 512;
+const int kBins = kFftSize / 2 + 1;
+const int kFilters = 26;
+const int kCoefficients = PronunciationScorer::kCoefficients;
+const float kPreEmphasis = 0.97f;
+// Frames more than 35 dB below the loudest one are silence.
+const float kSilenceRatio = 3.2e-4f;
+// Two unrelated frames of unit-variance coefficients are about
+// sqrt(2 * 13) = 5.1 apart; a good alignment stays well under that.
+const float kGoodDistance = 1.5f;
+const float kPoorDistance = 4.0f;
+
+// Everything that only depends on the frame and filterbank sizes.
+struct Tables
+{
+    float window[kFrameLength];
+    int bitReverse[kFftSize];
+    // The twiddles of the stage that combines halves of size h start at h.
+    float twiddleRe[kFftSize];
+    float twiddleIm[kFftSize];
+    int filterStart[kFilters];
+    int filterLength[kFilters];
+    float filterWeights[kFilters][kBins];
+    float dct[kCoefficients][kFilters];
+
+    Tables()
+    {
+        const double pi = 3.14159265358979323846;
+        for (int i = 0; i < kFrameLength; ++i) {
+            window[i] = float(0.54 - 0.46 * std::cos(2 * pi * i / (kFrameLength - 1)));
+        }
+
+        int bits = 0;
+        while ((1 << bits) < kFftSize) {
+            ++bits;
+        }
+        for (int i = 0; i < kFftSize; ++i) {
+            int reversed = 0;
+            for (int b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            bitReverse[i] = reversed;
+        }
+        for (int h = 1; h < kFftSize; h <<= 1) {
+            for (int j = 0; j < h; ++j) {
+                twiddleRe[h + j] = float(std::cos(-pi * j / h));
+                twiddleIm[h + j] = float(std::sin(-pi * j / h));
+            }
+        }
+
+        // Triangles evenly spaced on the mel scale from 0 Hz to Nyquist.
+        auto toMel = [](double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); };
+        auto toHz = [](double mel) { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); };
+        const double top = toMel(PronunciationScorer::kSampleRate / 2.0);
+        const double binHz = double(PronunciationScorer::kSampleRate) / kFftSize;
+        for (int m = 0; m < kFilters; ++m) {
+            double left = toHz(top * m / (kFilters + 1));
+            double centre = toHz(top * (m + 1) / (kFilters + 1));
+            double right = toHz(top * (m + 2) / (kFilters + 1));
+            filterStart[m] = int(std::ceil(left / binHz));
+            int end = qMin(kBins, int(std::floor(right / binHz)) + 1);
+            filterLength[m] = qMax(0, end - filterStart[m]);
+            for (int k = 0; k < filterLength[m]; ++k) {
+                double hz = (filterStart[m] + k) * binHz;
+                double weight = hz < centre ? (hz - left) / (centre - left) : (right - hz) / (right - centre);
+                filterWeights[m][k] = float(qMax(0.0, weight));
+            }
+        }
+
+        for (int c = 0; c < kCoefficients; ++c) {
+            for (int m = 0; m < kFilters; ++m) {
+                dct[c][m] = float(std::cos(pi * c * (m + 0.5) / kFilters));
+            }
+        }
+    }
+};
+
+const Tables& tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+// In place on split real and imaginary arrays; each butterfly loop runs over
+// contiguous data so the compiler vectorizes it.
+void fft(float* re, float* im, const Tables& t)
+{
+    for (int h = 1; h < kFftSize; h <<= 1) {
+        const float* wr = t.twiddleRe + h;
+        const float* wi = t.twiddleIm + h;
+        for (int block = 0; block < kFftSize; block += 2 * h) {
+            float* ar = re + block;
+            float* ai = im + block;
+            float* br = ar + h;
+            float* bi = ai + h;
+            for (int j = 0; j < h; ++j) {
+                float xr = br[j] * wr[j] - bi[j] * wi[j];
+                float xi = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - xr;
+                bi[j] = ai[j] - xi;
+                ar[j] += xr;
+                ai[j] += xi;
+            }
+        }
+    }
+}
+
+// A voiced sound whose two formants follow the given paths over the word,
+// with silence around it, standing in for a recorded word.
+QVector<float> syntheticWord(double seconds, double pitch, const double (&f1)[3], const double (&f2)[3])
+{
+    const double pi = 3.14159265358979323846;
+    const int pad = PronunciationScorer::kSampleRate / 10;
+    const int length = int(seconds * PronunciationScorer::kSampleRate);
+    QVector<float> samples(length + 2 * pad, 0.0f);
+    auto along = [](const double (&path)[3], double t) {
+        return t < 0.5 ? path[0] + (path[1] - path[0]) * t * 2 : path[1] + (path[2] - path[1]) * (t - 0.5) * 2;
+    };
+    QRandomGenerator random(7);
+    for (int i = 0; i < samples.size(); ++i) {
+        double value = (random.generateDouble() - 0.5) * 0.002;
+        if (i >= pad && i < pad + length) {
+            double t = double(i - pad) / length;
+            double time = double(i) / PronunciationScorer::kSampleRate;
+            double formant1 = along(f1, t);
+            double formant2 = along(f2, t);
+            double voiced = 0;
+            for (int h = 1; h * pitch < 4000; ++h) {
+                double hz = h * pitch;
+                double gain = std::exp(-std::pow((hz - formant1) / 150, 2)) + 0.5 * std::exp(-std::pow((hz - formant2) / 250, 2));
+                voiced += gain * std::sin(2 * pi * hz * time);
+            }
+            value += 0.2 * std::sin(pi * t) * voiced;
+        }
+        samples[i] = float(value);
+    }
+    return samples;
+}
+}
+
+QVector<float> PronunciationScorer::toMono(const QAudioFormat& format, const QByteArray& pcm)
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    if (!format.isValid() || bytesPerFrame <= 0) {
+        return QVector<float>();
+    }
+    const qsizetype frames = pcm.size() / bytesPerFrame;
+    const int channels = format.channelCount();
+    const int bytesPerSample = format.bytesPerSample();
+    QVector<float> mono(frames);
+    for (qsizetype i = 0; i < frames; ++i) {
+        const char* frame = pcm.constData() + i * bytesPerFrame;
+        float sum = 0;
+        for (int c = 0; c < channels; ++c) {
+            sum += format.normalizedSampleValue(frame + c * bytesPerSample);
+        }
+        mono[i] = sum / channels;
+    }
+    if (format.sampleRate() == kSampleRate || frames == 0) {
+        return mono;
+    }
+
+    const double step = double(format.sampleRate()) / kSampleRate;
+    const qsizetype outFrames = qsizetype(frames / step);
+    QVector<float> out(outFrames);
+    for (qsizetype i = 0; i < outFrames; ++i) {
+        double source = i * step;
+        qsizetype a = qsizetype(source);
+        qsizetype b = qMin(a + 1, frames - 1);
+        float t = float(source - a);
+        out[i] = mono[a] * (1 - t) + mono[b] * t;
+    }
+    return out;
+}
+
+QVector<float> PronunciationScorer::loadWav(const QString& path)
+{
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Float);
+    return SoundBank::decodeWav(path, format);
+}
+
+PronunciationScorer::Features PronunciationScorer::extract(const QVector<float>& samples)
+{
+    const Tables& t = tables();
+    Features features;
+    const int count = int(samples.size());
+    const int frames = count >= kFrameLength ? 1 + (count - kFrameLength) / kFrameStep : 0;
+    if (frames == 0) {
+        return features;
+    }
+
+    QVector<float> emphasized(count);
+    const float* in = samples.constData();
+    emphasized[0] = in[0];
+    for (int i = 1; i < count; ++i) {
+        emphasized[i] = in[i] - kPreEmphasis * in[i - 1];
+    }
+
+    // Frame-major while computing; transposed once the silence is trimmed.
+    QVector<float> cepstra(frames * kCoefficients);
+    QVector<float> energy(frames);
+    float re[kFftSize];
+    float im[kFftSize];
+    float power[kBins];
+    float mel[kFilters];
+    for (int f = 0; f < frames; ++f) {
+        const float* frame = emphasized.constData() + f * kFrameStep;
+        std::fill(re, re + kFftSize, 0.0f);
+        std::fill(im, im + kFftSize, 0.0f);
+        for (int i = 0; i < kFrameLength; ++i) {
+            re[t.bitReverse[i]] = frame[i] * t.window[i];
+        }
+        fft(re, im, t);
+
+        float total = 0;
+        for (int k = 0; k < kBins; ++k) {
+            power[k] = re[k] * re[k] + im[k] * im[k];
+            total += power[k];
+        }
+        energy[f] = total;
+
+        for (int m = 0; m < kFilters; ++m) {
+            const float* weights = t.filterWeights[m];
+            const float* bins = power + t.filterStart[m];
+            float sum = 0;
+            for (int k = 0; k < t.filterLength[m]; ++k) {
+                sum += weights[k] * bins[k];
+            }
+            mel[m] = std::log(qMax(sum, 1e-10f));
+        }
+
+        float* out = cepstra.data() + f * kCoefficients;
+        for (int c = 0; c < kCoefficients; ++c) {
+            float sum = 0;
+            for (int m = 0; m < kFilters; ++m) {
+                sum += t.dct[c][m] * mel[m];
+            }
+            out[c] = sum;
+        }
+    }
+
+    const float loudest = *std::max_element(energy.constBegin(), energy.constEnd());
+    if (loudest <= 0) {
+        return features;
+    }
+    int first = 0;
+    int last = frames - 1;
+    while (energy[first] < loudest * kSilenceRatio) {
+        ++first;
+    }
+    while (energy[last] < loudest * kSilenceRatio) {
+        --last;
+    }
+
+    // Per-coefficient mean and variance normalization takes out the
+    // microphone and most of the difference between voices.
+    const int kept = last - first + 1;
+    features.frames = kept;
+    features.values.resize(kept * kCoefficients);
+    for (int c = 0; c < kCoefficients; ++c) {
+        float* column = features.values.data() + c * kept;
+        double mean = 0;
+        for (int f = 0; f < kept; ++f) {
+            column[f] = cepstra[(first + f) * kCoefficients + c];
+            mean += column[f];
+        }
+        mean /= kept;
+        double variance = 0;
+        for (int f = 0; f < kept; ++f) {
+            variance += (column[f] - mean) * (column[f] - mean);
+        }
+        const float scale = float(1.0 / std::sqrt(variance / kept + 1e-6));
+        for (int f = 0; f < kept; ++f) {
+            column[f] = float(column[f] - mean) * scale;
+        }
+    }
+    return features;
+}
+
+float PronunciationScorer::distance(const Features& learner, const Features& reference)
+{
+    const int n = learner.frames;
+    const int m = reference.frames;
+    if (n == 0 || m == 0) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    // Symmetric steps: a diagonal move costs twice the local distance, so
+    // every path weighs n + m and the total can be normalized by that.
+    const float infinity = std::numeric_limits<float>::infinity();
+    QVector<float> local(m);
+    QVector<float> previous(m, infinity);
+    QVector<float> current(m);
+    for (int i = 0; i < n; ++i) {
+        // Distances from learner frame i to every reference frame, one
+        // coefficient at a time over contiguous reference frames.
+        std::fill(local.begin(), local.end(), 0.0f);
+        for (int c = 0; c < kCoefficients; ++c) {
+            const float a = learner.values[c * n + i];
+            const float* r = reference.values.constData() + c * m;
+            float* d = local.data();
+            for (int j = 0; j < m; ++j) {
+                float diff = a - r[j];
+                d[j] += diff * diff;
+            }
+        }
+        for (int j = 0; j < m; ++j) {
+            local[j] = std::sqrt(local[j]);
+        }
+
+        current[0] = i == 0 ? 2 * local[0] : previous[0] + local[0];
+        for (int j = 1; j < m; ++j) {
+            float diagonal = previous[j - 1] + 2 * local[j];
+            float up = previous[j] + local[j];
+            float left = current[j - 1] + local[j];
+            current[j] = qMin(diagonal, qMin(up, left));
+        }
+        previous.swap(current);
+    }
+    return previous[m - 1] / (n + m);
+}
+
+int PronunciationScorer::score(float distance)
+{
+    if (!std::isfinite(distance)) {
+        return 0;
+    }
+    float quality = (kPoorDistance - distance) / (kPoorDistance - kGoodDistance);
+    return qRound(100 * qBound(0.0f, quality, 1.0f));
+}
+
+int PronunciationScorer::score(const QVector<float>& learner, const QVector<float>& reference)
+{
+    return score(distance(extract(learner), extract(reference)));
+}
+
+void PronunciationScorer::runBenchmark(int runs)
+{
+    runs = qMax(1, runs);
+    // The reference is slower and lower than the learner, as a TTS voice
+    // usually is next to a child's.
+    const double f1[3] = { 300, 700, 400 };
+    const double f2[3] = { 2200, 1100, 1800 };
+    const double otherF1[3] = { 700, 300, 650 };
+    const double otherF2[3] = { 1000, 2300, 1200 };
+    QVector<float> learner = syntheticWord(1.0, 220, f1, f2);
+    QVector<float> reference = syntheticWord(0.8, 120, f1, f2);
+    QVector<float> other = syntheticWord(0.8, 120, otherF1, otherF2);
+
+    QElapsedTimer timer;
+    qint64 extractNs = 0;
+    qint64 dtwNs = 0;
+    float checksum = 0;
+    Features learnerFeatures;
+    Features referenceFeatures = extract(reference);
+    for (int run = 0; run < runs; ++run) {
+        timer.start();
+        learnerFeatures = extract(learner);
+        extractNs += timer.nsecsElapsed();
+        timer.start();
+        checksum += distance(learnerFeatures, referenceFeatures);
+        dtwNs += timer.nsecsElapsed();
+    }
+    Q_UNUSED(checksum);
+
+    const double extractMs = extractNs / 1e6 / runs;
+    const double dtwMs = dtwNs / 1e6 / runs;
+    qInfo().noquote() << QString("pronunciation: features %1 ms per 1 s clip, DTW %2 ms (%3 x %4 frames), %5 ms to score (target 10 ms); same word scores %6, other word %7")
+        .arg(extractMs, 0, 'f', 3)
+        .arg(dtwMs, 0, 'f', 3)
+        .arg(learnerFeatures.frames).arg(referenceFeatures.frames)
+        .arg(extractMs + dtwMs, 0, 'f', 3)
+        .arg(score(learner, reference))
+        .arg(score(learner, other));
+}
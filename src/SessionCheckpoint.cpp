@@ -0,0 +1,213 @@
+#include "SessionCheckpoint.h"
+#include "Trace.h"
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+const quint32 kSnapshotMagic = 0x454C4153; // "ELAS"
+const quint16 kSnapshotVersion = 2;
+const qint64 kCheckpointBudgetNs = 100000;
+}
+
+SessionCheckpoint::SessionCheckpoint(const QString& userName)
+    : generation(0)
+{
+    QString base = basePath(userName);
+    snapshotPath = base + ".snapshot";
+    journalPath = base + ".journal";
+    journal.setFileName(journalPath);
+}
+
+SessionCheckpoint::~SessionCheckpoint()
+{
+    journal.close();
+}
+
+QString SessionCheckpoint::currentUserName()
+{
+    ELA_TRACE_SCOPE("QSettings UserName");
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    return settings.value("UserName", "").toString();
+}
+
+QString SessionCheckpoint::basePath(const QString& userName)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sessions";
+    QDir().mkpath(dir);
+    return dir + "/" + QString::fromLatin1(userName.toUtf8().toHex());
+}
+
+void SessionCheckpoint::begin(const SessionState& state)
+{
+    journal.close();
+
+    QSaveFile file(snapshotPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write session snapshot:" << snapshotPath;
+        return;
+    }
+
+    generation = QRandomGenerator::global()->generate64();
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kSnapshotMagic << kSnapshotVersion << generation
+        << state.gameMode << state.level
+        << qint32(state.score) << qint32(state.currentWordCount) << qint32(state.position)
+        << state.currentKey << state.answered << state.board << state.boardTranslations;
+
+    // The journal is truncated only once the new snapshot is in place; if the
+    // app dies in between, the old records no longer match its generation.
+    if (!file.commit()) {
+        qWarning() << "Could not write session snapshot:" << snapshotPath;
+        return;
+    }
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not open session journal:" << journalPath;
+    }
+}
+
+void SessionCheckpoint::recordAnswer(const QString& word, int score, int wordCount)
+{
+    append(AnswerRecord, word, score, wordCount);
+}
+
+void SessionCheckpoint::recordCurrent(const QString& key)
+{
+    append(CurrentRecord, key, 0, 0);
+}
+
+void SessionCheckpoint::recordPosition(int position)
+{
+    append(PositionRecord, QString(), 0, position);
+}
+
+void SessionCheckpoint::append(RecordType type, const QString& word, int score, int count)
+{
+    if (!journal.isOpen()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << generation << quint8(type) << word << qint32(score) << qint32(count);
+
+    QByteArray record;
+    QDataStream rec(&record, QIODevice::WriteOnly);
+    rec.setVersion(QDataStream::Qt_6_0);
+    rec << quint32(payload.size());
+    rec.writeRawData(payload.constData(), payload.size());
+    rec << qChecksum(payload);
+
+    journal.write(record);
+    journal.flush();
+
+    if (timer.nsecsElapsed() > kCheckpointBudgetNs) {
+        qWarning() << "Session checkpoint took" << timer.nsecsElapsed() / 1000 << "us";
+    }
+}
+
+void SessionCheckpoint::clear()
+{
+    journal.close();
+    QFile::remove(journalPath);
+    QFile::remove(snapshotPath);
+}
+
+bool SessionCheckpoint::load(const QString& userName, SessionState& state)
+{
+    if (userName.isEmpty()) {
+        return false;
+    }
+
+    QString base = basePath(userName);
+    QFile snapshot(base + ".snapshot");
+    if (!snapshot.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&snapshot);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint64 generation = 0;
+    in >> magic >> version;
+    if (magic != kSnapshotMagic || version != kSnapshotVersion) {
+        return false;
+    }
+    in >> generation;
+
+    qint32 score = 0, wordCount = 0, position = 0;
+    in >> state.gameMode >> state.level >> score >> wordCount >> position
+       >> state.currentKey >> state.answered >> state.board >> state.boardTranslations;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    state.score = score;
+    state.currentWordCount = wordCount;
+    state.position = position;
+
+    QFile journalFile(base + ".journal");
+    if (!journalFile.open(QIODevice::ReadOnly)) {
+        return true;
+    }
+
+    // A record torn by a crash fails its checksum; everything after it is dropped.
+    QDataStream journalIn(&journalFile);
+    journalIn.setVersion(QDataStream::Qt_6_0);
+    while (!journalIn.atEnd()) {
+        quint32 size = 0;
+        journalIn >> size;
+        if (journalIn.status() != QDataStream::Ok || size > quint32(journalFile.size())) {
+            break;
+        }
+        QByteArray payload(int(size), Qt::Uninitialized);
+        if (journalIn.readRawData(payload.data(), int(size)) != int(size)) {
+            break;
+        }
+        quint16 checksum = 0;
+        journalIn >> checksum;
+        if (journalIn.status() != QDataStream::Ok || checksum != qChecksum(payload)) {
+            break;
+        }
+
+        QDataStream recordIn(payload);
+        recordIn.setVersion(QDataStream::Qt_6_0);
+        quint64 recordGeneration = 0;
+        quint8 type = 0;
+        QString word;
+        qint32 recordScore = 0, recordCount = 0;
+        recordIn >> recordGeneration >> type >> word >> recordScore >> recordCount;
+        if (recordGeneration != generation) {
+            break;
+        }
+
+        switch (type) {
+        case AnswerRecord:
+            if (!word.isEmpty() && !state.answered.contains(word)) {
+                state.answered.append(word);
+            }
+            state.score = recordScore;
+            state.currentWordCount = recordCount;
+            break;
+        case CurrentRecord:
+            state.currentKey = word;
+            break;
+        case PositionRecord:
+            state.position = recordCount;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
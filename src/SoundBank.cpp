@@ -0,0 +1,281 @@
+#include "SoundBank.h"
+#include "Trace.h"
+#include <QAudioSink>
+#include <QCoreApplication>
+#include <QFile>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QMutex>
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+
+namespace {
+const int kMaxVoices = 8;
+const int kBufferMicroseconds = 30000;
+const int kIdleSuspendMs = 2000;
+const char* const kSoundFiles[SoundBank::SoundCount] = {
+    ":/sounds/flip.wav",
+    ":/sounds/match.wav",
+    ":/sounds/mismatch.wav"
+};
+}
+
+// Endless stream the sink pulls from: the sum of every sound still playing,
+// or silence. Depending on the backend it is read from the audio thread.
+class SoundMixer : public QIODevice
+{
+public:
+    SoundMixer(const QAudioFormat& format, QObject* parent)
+        : QIODevice(parent)
+        , format(format)
+    {
+    }
+
+    void add(const QVector<float>* samples, float volume)
+    {
+        QMutexLocker lock(&mutex);
+        if (voices.size() >= kMaxVoices) {
+            voices.removeFirst();
+        }
+        voices.append(Voice { samples, 0, volume });
+    }
+
+    bool isSilent() const
+    {
+        QMutexLocker lock(&mutex);
+        return voices.isEmpty();
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return format.bytesForDuration(kBufferMicroseconds) + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override
+    {
+        const int bytesPerSample = format.bytesPerSample();
+        const qint64 samples = maxSize / format.bytesPerFrame() * format.channelCount();
+        mix.fill(0.0f, samples);
+        {
+            QMutexLocker lock(&mutex);
+            for (int i = voices.size() - 1; i >= 0; --i) {
+                Voice& voice = voices[i];
+                qint64 count = qMin(samples, qint64(voice.samples->size()) - voice.position);
+                const float* source = voice.samples->constData() + voice.position;
+                for (qint64 s = 0; s < count; ++s) {
+                    mix[s] += source[s] * voice.volume;
+                }
+                voice.position += count;
+                if (voice.position >= voice.samples->size()) {
+                    voices.removeAt(i);
+                }
+            }
+        }
+
+        for (qint64 s = 0; s < samples; ++s) {
+            float value = qBound(-1.0f, mix[s], 1.0f);
+            char* out = data + s * bytesPerSample;
+            switch (format.sampleFormat()) {
+            case QAudioFormat::UInt8:
+                *reinterpret_cast<quint8*>(out) = quint8(value * 127.0f + 128.0f);
+                break;
+            case QAudioFormat::Int16:
+                *reinterpret_cast<qint16*>(out) = qint16(value * 32767.0f);
+                break;
+            case QAudioFormat::Int32:
+                *reinterpret_cast<qint32*>(out) = qint32(value * 2147483647.0);
+                break;
+            default:
+                *reinterpret_cast<float*>(out) = value;
+                break;
+            }
+        }
+        return samples * bytesPerSample;
+    }
+
+    qint64 writeData(const char*, qint64) override
+    {
+        return -1;
+    }
+
+private:
+    struct Voice
+    {
+        const QVector<float>* samples;
+        qint64 position;
+        float volume;
+    };
+
+    QAudioFormat format;
+    mutable QMutex mutex;
+    QList<Voice> voices;
+    QVector<float> mix;
+};
+
+SoundBank& SoundBank::instance()
+{
+    static SoundBank* bank = new SoundBank(QCoreApplication::instance());
+    return *bank;
+}
+
+SoundBank::SoundBank(QObject* parent)
+    : QObject(parent)
+    , sink(nullptr)
+    , mixer(nullptr)
+    , idleTimer(new QTimer(this))
+{
+    // Streaming silence keeps the device busy, so it is suspended between bursts.
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(kIdleSuspendMs);
+    connect(idleTimer, &QTimer::timeout, this, [this]() {
+        if (!mixer->isSilent()) {
+            idleTimer->start();
+        } else if (sink->state() == QAudio::ActiveState || sink->state() == QAudio::IdleState) {
+            sink->suspend();
+        }
+    });
+}
+
+void SoundBank::preload()
+{
+    if (!sounds.isEmpty()) {
+        return;
+    }
+    ELA_TRACE_SCOPE("SoundBank::preload");
+
+    QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Float);
+    if (!device.isNull() && !device.isFormatSupported(format)) {
+        format = device.preferredFormat();
+    }
+
+    for (const char* file : kSoundFiles) {
+        sounds.append(decodeWav(file, format));
+    }
+
+    if (device.isNull()) {
+        qWarning() << "No audio output; sound effects are off.";
+        return;
+    }
+    mixer = new SoundMixer(format, this);
+    mixer->open(QIODevice::ReadOnly);
+    sink = new QAudioSink(device, format, this);
+    // A short buffer is what makes a click sound at once.
+    sink->setBufferSize(format.bytesForDuration(kBufferMicroseconds));
+    sink->start(mixer);
+    sink->suspend();
+}
+
+void SoundBank::play(Sound sound, float volume)
+{
+    preload();
+    if (!sink || sounds.at(sound).isEmpty()) {
+        return;
+    }
+    mixer->add(&sounds.at(sound), volume);
+    if (sink->state() == QAudio::SuspendedState) {
+        sink->resume();
+    }
+    idleTimer->start();
+}
+
+QVector<float> SoundBank::decodeWav(const QString& path, const QAudioFormat& format)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open sound:" << path;
+        return QVector<float>();
+    }
+    const QByteArray bytes = file.readAll();
+    if (bytes.size() < 12 || !bytes.startsWith("RIFF") || bytes.mid(8, 4) != "WAVE") {
+        qWarning() << "Not a WAV file:" << path;
+        return QVector<float>();
+    }
+
+    // Editors add their own chunks (JUNK, bext, ...) around fmt and data.
+    quint16 tag = 0;
+    quint16 channels = 0;
+    quint16 bits = 0;
+    quint32 rate = 0;
+    QByteArray pcm;
+    qsizetype pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        const char* chunk = bytes.constData() + pos;
+        quint32 size = qFromLittleEndian<quint32>(chunk + 4);
+        qsizetype body = pos + 8;
+        if (qstrncmp(chunk, "fmt ", 4) == 0 && size >= 16 && body + 16 <= bytes.size()) {
+            tag = qFromLittleEndian<quint16>(chunk + 8);
+            channels = qFromLittleEndian<quint16>(chunk + 10);
+            rate = qFromLittleEndian<quint32>(chunk + 12);
+            bits = qFromLittleEndian<quint16>(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE: the sub-format GUID starts with the real tag.
+            if (tag == 0xFFFE && size >= 26 && body + 26 <= bytes.size()) {
+                tag = qFromLittleEndian<quint16>(chunk + 32);
+            }
+        } else if (qstrncmp(chunk, "data", 4) == 0) {
+            pcm = bytes.mid(body, qMin<qsizetype>(size, bytes.size() - body));
+        }
+        pos = body + size + (size & 1);
+    }
+
+    bool supported = (tag == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32))
+                  || (tag == 3 && bits == 32);
+    if (!supported || channels == 0 || rate == 0 || pcm.isEmpty()) {
+        qWarning() << "Unsupported WAV format in" << path << "tag" << tag << "bits" << bits;
+        return QVector<float>();
+    }
+
+    const int bytesPerSample = bits / 8;
+    const qsizetype frames = pcm.size() / (bytesPerSample * channels);
+    const uchar* data = reinterpret_cast<const uchar*>(pcm.constData());
+    auto sampleAt = [&](qsizetype frame, int channel) -> float {
+        const uchar* p = data + (frame * channels + channel) * bytesPerSample;
+        switch (bits) {
+        case 8:
+            return (p[0] - 128) / 128.0f;
+        case 16:
+            return qFromLittleEndian<qint16>(p) / 32768.0f;
+        case 24: {
+            qint32 value = p[0] | (p[1] << 8) | (p[2] << 16);
+            if (value & 0x800000) {
+                value -= 0x1000000;
+            }
+            return value / 8388608.0f;
+        }
+        default:
+            return tag == 3 ? qFromLittleEndian<float>(p) : qFromLittleEndian<qint32>(p) / 2147483648.0f;
+        }
+    };
+
+    const int outChannels = format.channelCount();
+    auto frameValue = [&](qsizetype frame, int channel) -> float {
+        if (outChannels == 1 && channels > 1) {
+            return (sampleAt(frame, 0) + sampleAt(frame, 1)) / 2;
+        }
+        return sampleAt(frame, qMin(channel, channels - 1));
+    };
+
+    // Linear resampling is plenty for short feedback sounds.
+    const double step = double(rate) / format.sampleRate();
+    const qsizetype outFrames = qsizetype(frames / step);
+    QVector<float> out(outFrames * outChannels);
+    for (qsizetype i = 0; i < outFrames; ++i) {
+        double source = i * step;
+        qsizetype a = qsizetype(source);
+        qsizetype b = qMin(a + 1, frames - 1);
+        float t = float(source - a);
+        for (int c = 0; c < outChannels; ++c) {
+            out[i * outChannels + c] = frameValue(a, c) * (1 - t) + frameValue(b, c) * t;
+        }
+    }
+    return out;
+}
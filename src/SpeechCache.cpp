@@ -0,0 +1,514 @@
+#include "SpeechCache.h"
+#include "AudioPack.h"
+#include <QAudioSink>
+#include <QCache>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMediaDevices>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+const quint32 kClipMagic = 0x454C4156; // "ELAV"
+const quint16 kClipVersion = 1;
+const int kMemoryBudgetKb = 16 * 1024;
+const qint64 kDiskBudgetBytes = 64 * 1024 * 1024;
+
+QCache<QString, SpeechCache::Clip>& memoryCache()
+{
+    static QCache<QString, SpeechCache::Clip> cache(kMemoryBudgetKb);
+    return cache;
+}
+
+SpeechCache::Stats counters;
+QSet<QString> prefetchedKeys;
+
+QString cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/speech";
+}
+
+QString clipPath(const QString& key)
+{
+    QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDirectory() + "/" + QString::fromLatin1(hash) + ".pcm";
+}
+
+// Drops the least recently used clips once the directory outgrows its
+// budget. Hits touch the file, so modification time is the last use.
+void pruneDisk()
+{
+    QDir dir(cacheDirectory());
+    QFileInfoList files = dir.entryInfoList({ "*.pcm" }, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo& info : files) {
+        total += info.size();
+        if (total > kDiskBudgetBytes) {
+            QFile::remove(info.absoluteFilePath());
+        }
+    }
+}
+}
+
+SpeechCache::SpeechCache(QTextToSpeech* engine, QObject* parent)
+    : QObject(parent)
+    , engine(engine)
+    , sink(nullptr)
+    , timingReplay(false)
+    , timingFirstAudio(false)
+    , saying(false)
+    , synthesizing(false)
+    , playWhenSynthesized(false)
+{
+    defaultVoices.insert(engine->locale().name(), engine->voice());
+    connect(engine, &QTextToSpeech::stateChanged, this, &SpeechCache::engineStateChanged);
+}
+
+void SpeechCache::speak(const Request& request)
+{
+    if (request.text.isEmpty()) {
+        return;
+    }
+    if (!queued.text.isEmpty()) {
+        ++counters.superseded;
+        queued = Request();
+    }
+
+    replayClock.start();
+    timingFirstAudio = true;
+    Clip clip;
+    // Packs come first and need no synthesis, so they work with any engine.
+    if (fromPack(request, clip)) {
+        ++counters.packHits;
+        play(clip, true);
+        return;
+    }
+
+    if (!canSynthesize()) {
+        timingFirstAudio = false;
+        ++counters.spoken;
+        applyVoice(request);
+        // Some engines queue say() behind the utterance still running.
+        saying = false;
+        engine->stop();
+        saying = true;
+        engine->say(request.text);
+        return;
+    }
+
+    QString key = keyFor(request);
+    bool fromDisk = false;
+    if (lookup(key, clip, fromDisk)) {
+        ++(fromDisk ? counters.diskHits : counters.memoryHits);
+        if (prefetchedKeys.remove(key)) {
+            ++counters.prefetchHits;
+        }
+        play(clip, true);
+        return;
+    }
+
+    if (sink) {
+        sink->stop();
+    }
+    if (synthesizing && key == synthesisKey) {
+        // Asked for while still being prefetched; play it as soon as it is done.
+        ++counters.misses;
+        prefetchedKeys.remove(key);
+        playWhenSynthesized = true;
+        return;
+    }
+    if (synthesizing) {
+        // A synthesis is not cut short: it is usually a word, and the clip
+        // is still worth caching. The newest request runs right after it.
+        if (playWhenSynthesized) {
+            ++counters.superseded;
+        }
+        queued = request;
+        playWhenSynthesized = false;
+        return;
+    }
+    ++counters.misses;
+    startSynthesis(request, true);
+}
+
+void SpeechCache::prefetch(const Request& request)
+{
+    if (request.text.isEmpty() || !canSynthesize()) {
+        return;
+    }
+    QString key = keyFor(request);
+    Clip clip;
+    bool fromDisk = false;
+    if ((synthesizing && key == synthesisKey) || fromPack(request, clip) || lookup(key, clip, fromDisk)) {
+        return;
+    }
+    if (synthesizing) {
+        prefetchRequest = request;
+        return;
+    }
+    ++counters.prefetched;
+    prefetchedKeys.insert(key);
+    startSynthesis(request, false);
+}
+
+void SpeechCache::stop()
+{
+    queued = Request();
+    prefetchRequest = Request();
+    playWhenSynthesized = false;
+    timingReplay = false;
+    timingFirstAudio = false;
+    if (sink) {
+        sink->stop();
+    }
+    // A synthesis in progress still finishes so the clip ends up cached.
+    if (!synthesizing) {
+        engine->stop();
+    }
+}
+
+bool SpeechCache::isSpeaking() const
+{
+    bool playing = sink && sink->state() == QAudio::ActiveState;
+    return playing || saying || timingFirstAudio || !queued.text.isEmpty()
+        || (synthesizing && playWhenSynthesized);
+}
+
+bool SpeechCache::isBusy() const
+{
+    return synthesizing || timingReplay || timingFirstAudio;
+}
+
+bool SpeechCache::canSynthesize() const
+{
+    return engine->engineCapabilities().testFlag(QTextToSpeech::Capability::Synthesize);
+}
+
+QString SpeechCache::keyFor(const Request& request) const
+{
+    // The default voice is keyed by its locale alone, so finding a clip never
+    // needs the engine to switch over just to learn the voice's name.
+    return QStringList {
+        engine->engine(),
+        request.voice.name(),
+        request.locale.name(),
+        QString::number(engine->rate()),
+        QString::number(engine->pitch()),
+        request.text
+    }.join(QChar(0x1f));
+}
+
+bool SpeechCache::findClip(const Request& request, Clip& clip) const
+{
+    if (fromPack(request, clip)) {
+        return true;
+    }
+    bool fromDisk = false;
+    return canSynthesize() && lookup(keyFor(request), clip, fromDisk);
+}
+
+bool SpeechCache::fromPack(const Request& request, Clip& clip) const
+{
+    // Packs are synthesized at the engine's normal rate and pitch.
+    if (engine->rate() != 0 || engine->pitch() != 0) {
+        return false;
+    }
+    return AudioPack::find(request.locale, request.voice.name(), request.text, clip.format, clip.pcm);
+}
+
+void SpeechCache::applyVoice(const Request& request)
+{
+    // Switching either one reloads voice data in some engines.
+    if (engine->locale() != request.locale) {
+        engine->setLocale(request.locale);
+        if (!defaultVoices.contains(request.locale.name())) {
+            defaultVoices.insert(request.locale.name(), engine->voice());
+        }
+    }
+    QVoice voice = request.voice.name().isEmpty() ? defaultVoices.value(request.locale.name()) : request.voice;
+    if (!voice.name().isEmpty() && engine->voice() != voice) {
+        engine->setVoice(voice);
+    }
+}
+
+void SpeechCache::play(const Clip& clip, bool timed)
+{
+    if (!sink || sink->format() != clip.format) {
+        delete sink;
+        sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), clip.format, this);
+        connect(sink, &QAudioSink::stateChanged, this, [this](QAudio::State state) {
+            if (state == QAudio::ActiveState && (timingReplay || timingFirstAudio)) {
+                qint64 ns = replayClock.nsecsElapsed();
+                if (timingFirstAudio) {
+                    ++counters.firstAudioCount;
+                    counters.firstAudioNsTotal += ns;
+                    counters.firstAudioNsMax = qMax(counters.firstAudioNsMax, ns);
+                    counters.lastFirstAudioNs = ns;
+                }
+                if (timingReplay) {
+                    ++counters.timedReplays;
+                    counters.replayNsTotal += ns;
+                    counters.replayNsMax = qMax(counters.replayNsMax, ns);
+                    counters.lastReplayNs = ns;
+                }
+                timingReplay = false;
+                timingFirstAudio = false;
+            } else if (state == QAudio::IdleState) {
+                // The whole clip has been played.
+                sink->stop();
+                emit finished();
+            } else if (state == QAudio::StoppedState && sink->error() != QAudio::NoError) {
+                qWarning() << "Speech playback failed:" << sink->error();
+                timingReplay = false;
+                timingFirstAudio = false;
+                emit finished();
+            }
+        });
+    }
+
+    sink->stop();
+    playback.close();
+    playback.setData(clip.pcm);
+    playback.open(QIODevice::ReadOnly);
+    sink->setVolume(engine->volume());
+    timingReplay = timed;
+    sink->start(&playback);
+}
+
+void SpeechCache::startSynthesis(const Request& request, bool playWhenDone)
+{
+    applyVoice(request);
+    synthesizing = true;
+    playWhenSynthesized = playWhenDone;
+    synthesisRequest = request;
+    synthesisKey = keyFor(request);
+    synthesized = Clip();
+    engine->synthesize(request.text, this, [this](const QAudioFormat& format, const QByteArray& bytes) {
+        synthesized.format = format;
+        synthesized.pcm.append(bytes);
+    });
+}
+
+void SpeechCache::engineStateChanged(QTextToSpeech::State state)
+{
+    if (saying && state != QTextToSpeech::Speaking) {
+        saying = false;
+        emit finished();
+        return;
+    }
+    if (!synthesizing || state == QTextToSpeech::Synthesizing) {
+        return;
+    }
+    synthesizing = false;
+
+    if (state == QTextToSpeech::Ready && !synthesized.pcm.isEmpty()) {
+        store(synthesisKey, synthesized);
+        if (playWhenSynthesized) {
+            play(synthesized, false);
+        }
+    } else if (state == QTextToSpeech::Error) {
+        qWarning() << "Speech synthesis failed:" << engine->errorString();
+        if (playWhenSynthesized) {
+            ++counters.spoken;
+            timingFirstAudio = false;
+            saying = true;
+            engine->say(synthesisRequest.text);
+        }
+    }
+    synthesized = Clip();
+
+    if (!queued.text.isEmpty()) {
+        Request next = queued;
+        queued = Request();
+        // First audio counts from the original request, not from now.
+        QElapsedTimer requested = replayClock;
+        speak(next);
+        replayClock = requested;
+    } else if (!prefetchRequest.text.isEmpty()) {
+        Request next = prefetchRequest;
+        prefetchRequest = Request();
+        prefetch(next);
+    }
+}
+
+bool SpeechCache::lookup(const QString& key, Clip& clip, bool& fromDisk)
+{
+    if (Clip* cached = memoryCache().object(key)) {
+        clip = *cached;
+        fromDisk = false;
+        return true;
+    }
+
+    // Opened for writing only to touch it, so a missing clip must not be created.
+    QFile file(clipPath(key));
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString storedKey;
+    qint32 sampleRate = 0;
+    qint32 channelCount = 0;
+    qint32 sampleFormat = 0;
+    in >> magic >> version;
+    if (magic != kClipMagic || version != kClipVersion) {
+        return false;
+    }
+    in >> storedKey >> sampleRate >> channelCount >> sampleFormat >> clip.pcm;
+    if (in.status() != QDataStream::Ok || storedKey != key || clip.pcm.isEmpty()) {
+        return false;
+    }
+    clip.format.setSampleRate(sampleRate);
+    clip.format.setChannelCount(channelCount);
+    clip.format.setSampleFormat(QAudioFormat::SampleFormat(sampleFormat));
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    memoryCache().insert(key, new Clip(clip), clip.pcm.size() / 1024 + 1);
+    fromDisk = true;
+    return true;
+}
+
+void SpeechCache::store(const QString& key, const Clip& clip)
+{
+    memoryCache().insert(key, new Clip(clip), clip.pcm.size() / 1024 + 1);
+
+    static bool pruned = false;
+    if (!pruned) {
+        QDir().mkpath(cacheDirectory());
+        pruneDisk();
+        pruned = true;
+    }
+
+    QSaveFile file(clipPath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write speech cache:" << file.fileName();
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kClipMagic << kClipVersion << key
+        << qint32(clip.format.sampleRate()) << qint32(clip.format.channelCount())
+        << qint32(clip.format.sampleFormat()) << clip.pcm;
+    file.commit();
+}
+
+SpeechCache::Stats SpeechCache::stats()
+{
+    return counters;
+}
+
+QString SpeechCache::summary()
+{
+    int hits = counters.memoryHits + counters.diskHits + counters.packHits;
+    int lookups = hits + counters.misses;
+    return QString("speech cache: %1 memory hits, %2 disk hits, %3 misses (hit rate %4%), %5 spoken directly, %13 superseded; replay start avg %6 ms, max %7 ms (target 20 ms); prefetch %8 of %9 used (%10%); first audio avg %11 ms, max %12 ms; %14 from audio packs")
+        .arg(counters.memoryHits).arg(counters.diskHits).arg(counters.misses)
+        .arg(lookups ? 100.0 * hits / lookups : 0.0, 0, 'f', 1)
+        .arg(counters.spoken)
+        .arg(counters.timedReplays ? counters.replayNsTotal / 1e6 / counters.timedReplays : 0.0, 0, 'f', 2)
+        .arg(counters.replayNsMax / 1e6, 0, 'f', 2)
+        .arg(counters.prefetchHits).arg(counters.prefetched)
+        .arg(counters.prefetched ? 100.0 * counters.prefetchHits / counters.prefetched : 0.0, 0, 'f', 1)
+        .arg(counters.firstAudioCount ? counters.firstAudioNsTotal / 1e6 / counters.firstAudioCount : 0.0, 0, 'f', 2)
+        .arg(counters.firstAudioNsMax / 1e6, 0, 'f', 2)
+        .arg(counters.superseded)
+        .arg(counters.packHits);
+}
+
+void SpeechCache::clearMemory()
+{
+    memoryCache().clear();
+}
+
+void SpeechCache::runBenchmark(int replays)
+{
+    replays = qMax(1, replays);
+
+    QTextToSpeech engine;
+    SpeechCache player(&engine);
+    if (!player.canSynthesize()) {
+        qInfo().noquote() << QString("speech cache: engine '%1' cannot synthesize to PCM; speech goes through say() uncached")
+            .arg(engine.engine());
+        return;
+    }
+
+    auto waitIdle = [&player](int timeoutMs) {
+        QElapsedTimer timer;
+        timer.start();
+        while (player.isBusy() && timer.elapsed() < timeoutMs) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+        }
+        return !player.isBusy();
+    };
+
+    // A word this run is unlikely to have cached, so the first call synthesizes.
+    const Request word { QString("benchmark %1").arg(QDateTime::currentMSecsSinceEpoch()),
+                         QLocale(QLocale::English, QLocale::UnitedStates), QVoice() };
+    QElapsedTimer synthesis;
+    synthesis.start();
+    player.speak(word);
+    if (!waitIdle(10000)) {
+        qWarning() << "Synthesis did not finish within 10 s.";
+        return;
+    }
+    double synthesisMs = synthesis.nsecsElapsed() / 1e6;
+
+    Stats before = counters;
+    for (int i = 0; i < replays; ++i) {
+        player.speak(word);
+        if (!waitIdle(1000)) {
+            qWarning() << "Playback did not start; is an audio output available?";
+            return;
+        }
+    }
+    Stats memory = counters;
+
+    clearMemory();
+    player.speak(word);
+    waitIdle(1000);
+    double diskMs = counters.lastReplayNs / 1e6;
+    player.stop();
+    QFile::remove(clipPath(player.keyFor(word)));
+
+    // Rapid "next" clicks on words that are not cached: only the last one
+    // should be heard, at most one stale synthesis later.
+    const int clicks = 10;
+    QList<Request> rapid;
+    for (int i = 0; i < clicks; ++i) {
+        rapid.append(Request { QString("%1 rapid %2").arg(word.text).arg(i), word.locale, QVoice() });
+    }
+    int supersededBefore = counters.superseded;
+    for (const Request& request : rapid) {
+        player.speak(request);
+        QElapsedTimer gap;
+        gap.start();
+        while (gap.elapsed() < 30) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+        }
+    }
+    waitIdle(10000);
+    double rapidMs = counters.lastFirstAudioNs / 1e6;
+    player.stop();
+    waitIdle(10000);
+    for (const Request& request : rapid) {
+        QFile::remove(clipPath(player.keyFor(request)));
+    }
+
+    int timed = memory.timedReplays - before.timedReplays;
+    qInfo().noquote() << QString("speech cache: synthesis %1 ms; memory hit replay start avg %2 ms over %3; disk hit replay start %4 ms (target 20 ms); %5 rapid clicks 30 ms apart: last word heard after %6 ms, %7 superseded")
+        .arg(synthesisMs, 0, 'f', 1)
+        .arg(timed ? (memory.replayNsTotal - before.replayNsTotal) / 1e6 / timed : 0.0, 0, 'f', 2)
+        .arg(timed)
+        .arg(diskMs, 0, 'f', 2)
+        .arg(clicks)
+        .arg(rapidMs, 0, 'f', 1)
+        .arg(counters.superseded - supersededBefore);
+}
@@ -0,0 +1,126 @@
+#include "SpeechService.h"
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <QDebug>
+
+SpeechService& SpeechService::instance()
+{
+    // Owned by the application so the engine goes away before the plugins do.
+    static SpeechService* service = new SpeechService(QCoreApplication::instance());
+    return *service;
+}
+
+SpeechService::SpeechService(QObject* parent)
+    : QObject(parent)
+    , engine(nullptr)
+    , cache(nullptr)
+    , starting(false)
+{
+}
+
+void SpeechService::start()
+{
+    if (engine || starting) {
+        return;
+    }
+    starting = true;
+    QTimer::singleShot(0, this, &SpeechService::createEngine);
+}
+
+bool SpeechService::isReady() const
+{
+    return engine != nullptr;
+}
+
+void SpeechService::createEngine()
+{
+    ELA_TRACE_SCOPE("SpeechService engine init");
+    engine = new QTextToSpeech(this);
+    cache = new SpeechCache(engine, this);
+    connect(cache, &SpeechCache::finished, this, &SpeechService::speakNext);
+    starting = false;
+    if (Trace::isEnabled()) {
+        qInfo().noquote() << QString("speech: engine %1 ready with %2 locales")
+                                 .arg(engine->engine()).arg(engine->availableLocales().size());
+    }
+
+    emit ready();
+
+    // Whatever was asked for while the engine loaded, in order.
+    speakNext();
+}
+
+QList<QVoice> SpeechService::voices(const QLocale& locale)
+{
+    if (!engine) {
+        return QList<QVoice>();
+    }
+    auto it = catalogue.constFind(locale.language());
+    if (it == catalogue.constEnd()) {
+        it = catalogue.insert(locale.language(), engine->findVoices(locale.language()));
+    }
+    return *it;
+}
+
+void SpeechService::speak(const QString& text, const QLocale& locale, const QVoice& voice,
+                          Priority priority)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    SpeechCache::Request request { text, locale, voice };
+
+    switch (priority) {
+    case Word:
+        // Anything still waiting belongs to a word the learner has left.
+        waiting.clear();
+        if (!engine) {
+            waiting.append(request);
+            start();
+            return;
+        }
+        cache->speak(request);
+        break;
+    case Example:
+        if (!engine || cache->isSpeaking()) {
+            waiting.append(request);
+            start();
+            return;
+        }
+        cache->speak(request);
+        break;
+    case Prefetch:
+        prefetch(text, locale, voice);
+        break;
+    }
+}
+
+void SpeechService::prefetch(const QString& text, const QLocale& locale, const QVoice& voice)
+{
+    if (!engine || text.isEmpty()) {
+        return;
+    }
+    cache->prefetch(SpeechCache::Request { text, locale, voice });
+}
+
+void SpeechService::stop()
+{
+    waiting.clear();
+    if (cache) {
+        cache->stop();
+    }
+}
+
+bool SpeechService::findClip(const QString& text, const QLocale& locale, SpeechCache::Clip& clip,
+                             const QVoice& voice) const
+{
+    return cache && cache->findClip(SpeechCache::Request { text, locale, voice }, clip);
+}
+
+void SpeechService::speakNext()
+{
+    if (!waiting.isEmpty()) {
+        cache->speak(waiting.takeFirst());
+    }
+}
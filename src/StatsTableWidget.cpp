@@ -1,4 +1,11 @@
 #include "StatsTableWidget.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
+#include "ProgressArchive.h"
+#include "ProgressSync.h"
+#include "ProgressStats.h"
+#include "ConfusionMatrix.h"
+#include "Trace.h"
 #include <QSettings>
 #include <QTableWidget>
 #include <QVBoxLayout>
@@ -7,113 +14,91 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <QLabel>
-#include <QPainter>
 #include <QGuiApplication>
 #include <QScreen>
 #include <QHeaderView>
+#include <QFileDialog>
+#include <QMenu>
 
 StatsTableWidget::StatsTableWidget(QWidget* parent)
     : QWidget(parent)
 {
-    QSettings settings("MyCompany", "EnglishLearningApp");
-
+    ELA_TRACE_SCOPE("StatsTableWidget::StatsTableWidget");
     QLabel* imageLabel = new QLabel(this);
     imageLabel->setScaledContents(true);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     
-    QPixmap pixmap(":/Learn-English.png");
-    QImage image = pixmap.toImage();
-    QImage transparentImage(image.size(), QImage::Format_ARGB32);
-    transparentImage.fill(Qt::transparent);
-    QPainter painter(&transparentImage);
-    painter.setOpacity(0.3);
-    painter.drawImage(0, 0, image);
-    painter.end();
-    QPixmap transparentPixmap = QPixmap::fromImage(transparentImage);
-    imageLabel->setPixmap(transparentPixmap.scaled(500, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    BackgroundCache::applyTo(imageLabel, 0.3, QSize(500, 400));
     imageLabel->setFixedSize(500, 400);
     imageLabel->lower();
 
-    QTableWidget* table = new QTableWidget(this);
+    table = new QTableWidget(this);
     table->setColumnCount(3); 
-    table->setHorizontalHeaderLabels({"שם משתמש", "סוג משחק", "ניקוד"});
+    table->setHorizontalHeaderLabels({"מקום", "שם משתמש", "ניקוד"});
     table->setEditTriggers(QAbstractItemView::NoEditTriggers); 
     table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    table->setStyleSheet(
-        "QTableWidget {"
-        "   background-color: rgba(255, 255, 255, 0.7);"
-        "   color: #333333;"
-        "   font-size: 16px;"
-        "   border: 3px solid #ebbf00;"
-        "   border-radius: 10px;"
-        "   padding: 5px;"
-        "}"
-        "QTableWidget::item {"
-        "   padding: 10px;"
-        "   background-color: transparent;" 
-        "   color: #333333;" 
-        "   border: none;" 
-        "}"
-        "QHeaderView::section {"
-        "   background-color: #ebbf00;"
-        "   color: black;"
-        "   font-weight: bold;"
-        "   font-size: 18px;"
-        "   padding: 10px;"
-        "   border: 1px solid #ebbf00;"
-        "   border-radius: 5px;"
-        "}"
-        "QTableWidget::item:hover {"
-        "   background-color: transparent;" 
-        "   color: #333333;" 
-        "}"
-    );
+    AppStyle::setRole(table, "leaderboard");
 
-    QStringList keys = settings.allKeys();
-    for (const QString& key : keys) {
-        QStringList parts = key.split('/');
-        if (parts.size() == 3 && parts[2] == "score") {
-            QString userName = parts[0];
-            QString gameType = parts[1];
-            int score = settings.value(key).toInt();
-
-            int row = table->rowCount();
-            table->insertRow(row);
-            table->setItem(row, 0, new QTableWidgetItem(userName));
-            table->setItem(row, 1, new QTableWidgetItem(gameType));
-            table->setItem(row, 2, new QTableWidgetItem(QString::number(score)));
-
-            table->item(row, 0)->setFlags(table->item(row, 0)->flags() & ~Qt::ItemIsEditable);
-            table->item(row, 1)->setFlags(table->item(row, 1)->flags() & ~Qt::ItemIsEditable);
-            table->item(row, 2)->setFlags(table->item(row, 2)->flags() & ~Qt::ItemIsEditable);
-        }
+    gameCombo = new QComboBox(this);
+    gameCombo->addItem("תרגול עברית", "Hebrew");
+    gameCombo->addItem("תרגול אנגלית", "English");
+    gameCombo->addItem("משחק התאמה", "MemoryGame");
+    gameCombo->addItem("מילים נופלות", "Arcade");
+
+    levelCombo = new QComboBox(this);
+    levelCombo->addItem("כל הרמות", 0);
+    for (int level = 1; level <= 5; ++level) {
+        levelCombo->addItem(QString("רמה %1").arg(level), level);
     }
 
+    streakLabel = new QLabel(this);
+    AppStyle::setRole(streakLabel, "status");
+
+    connect(gameCombo, &QComboBox::currentIndexChanged, this, &StatsTableWidget::refreshTable);
+    connect(levelCombo, &QComboBox::currentIndexChanged, this, &StatsTableWidget::refreshTable);
+
+    refreshTable();
+
     QPushButton* deleteScoresBtn = new QPushButton("מחק ניקוד", this);
-    deleteScoresBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: #ebbf00;"
-        "   color: black;"
-        "   font-size: 16px;"
-        "   padding: 12px;"
-        "   border-radius: 10px;"
-        "   font-weight: bold;"
-        "   box-shadow: 0 4px 6px rgba(0, 0, 0, 0.1);"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #D4A017;"
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #ebbf00;"
-        "}"
-    );
-    connect(deleteScoresBtn, &QPushButton::clicked, [this, table]() {
+    AppStyle::setRole(deleteScoresBtn, "toolbar");
+    connect(deleteScoresBtn, &QPushButton::clicked, [this]() {
         deleteUserScores(table);
     });
 
+    QPushButton* exportBtn = new QPushButton("ייצוא התקדמות", this);
+    QPushButton* importBtn = new QPushButton("ייבוא התקדמות", this);
+    AppStyle::setRole(exportBtn, "toolbar");
+    AppStyle::setRole(importBtn, "toolbar");
+    connect(exportBtn, &QPushButton::clicked, this, &StatsTableWidget::exportProgress);
+    connect(importBtn, &QPushButton::clicked, this, &StatsTableWidget::importProgress);
+
+    QPushButton* syncBtn = new QPushButton("סנכרון מכשירים", this);
+    AppStyle::setRole(syncBtn, "toolbar");
+    QMenu* syncMenu = new QMenu(syncBtn);
+    syncMenu->addAction("שמור קובץ מכשיר", this, &StatsTableWidget::exportDeviceState);
+    syncMenu->addAction("מזג קובץ מכשיר", this, &StatsTableWidget::mergeDeviceState);
+    syncBtn->setMenu(syncMenu);
+
+    QPushButton* confusionBtn = new QPushButton("מילים מבולבלות", this);
+    AppStyle::setRole(confusionBtn, "toolbar");
+    connect(confusionBtn, &QPushButton::clicked, this, &StatsTableWidget::showConfusions);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(deleteScoresBtn);
+    buttonLayout->addWidget(exportBtn);
+    buttonLayout->addWidget(importBtn);
+    buttonLayout->addWidget(syncBtn);
+    buttonLayout->addWidget(confusionBtn);
+
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(gameCombo);
+    filterLayout->addWidget(levelCombo);
+
     QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addLayout(filterLayout);
+    layout->addWidget(streakLabel);
     layout->addWidget(table);
-    layout->addWidget(deleteScoresBtn, 0, Qt::AlignCenter);
+    layout->addLayout(buttonLayout);
     setLayout(layout);
 
     resize(500, 400);
@@ -127,6 +112,125 @@ StatsTableWidget::StatsTableWidget(QWidget* parent)
     }
 }
 
+void StatsTableWidget::refreshTable()
+{
+    ELA_TRACE_SCOPE("StatsTableWidget::refreshTable");
+    const ProgressStats& stats = ProgressStats::instance();
+    const QList<ProgressStats::Entry> entries =
+        stats.top(gameCombo->currentData().toString(), levelCombo->currentData().toInt());
+
+    table->setRowCount(0);
+    for (const ProgressStats::Entry& entry : entries) {
+        int row = table->rowCount();
+        table->insertRow(row);
+        table->setItem(row, 0, new QTableWidgetItem(QString::number(row + 1)));
+        table->setItem(row, 1, new QTableWidgetItem(entry.user));
+        table->setItem(row, 2, new QTableWidgetItem(QString::number(entry.score)));
+    }
+
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    QString userName = settings.value("UserName", "").toString();
+    int answers = stats.recentAnswers(userName);
+    QString accuracy = answers > 0
+        ? QString("%1%").arg(stats.recentCorrect(userName) * 100 / answers)
+        : QString("-");
+    streakLabel->setText(QString("רצף ימים: %1 (שיא: %2) | דיוק ב-%3 התשובות האחרונות: %4")
+        .arg(stats.currentStreak(userName))
+        .arg(stats.bestStreak(userName))
+        .arg(answers)
+        .arg(accuracy));
+}
+
+void StatsTableWidget::showConfusions()
+{
+    const QList<ConfusionMatrix::Pair> pairs = ConfusionMatrix::instance().mostConfused(QString(), 15);
+    if (pairs.isEmpty()) {
+        QMessageBox::information(this, "מילים מבולבלות", "עדיין אין נתונים.");
+        return;
+    }
+
+    QStringList lines;
+    for (const ConfusionMatrix::Pair& pair : pairs) {
+        lines.append(QString("%1 ← %2 (%3)").arg(pair.expected).arg(pair.given).arg(pair.count));
+    }
+    QMessageBox::information(this, "מילים מבולבלות", lines.join("\n"));
+}
+
+void StatsTableWidget::exportProgress()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "ייצוא התקדמות", "progress.elax", "Progress archive (*.elax)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    ProgressLog log;
+    QString error;
+    if (!ProgressArchive(settings, log).exportTo(filePath, &error)) {
+        QMessageBox::critical(this, "Error", QString("Export failed: %1").arg(error));
+        return;
+    }
+    QMessageBox::information(this, "Success", "ההתקדמות יוצאה בהצלחה.");
+}
+
+void StatsTableWidget::importProgress()
+{
+    QString filePath = QFileDialog::getOpenFileName(this, "ייבוא התקדמות", QString(), "Progress archive (*.elax)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    ProgressLog log;
+    QString error;
+    if (!ProgressArchive(settings, log).importFrom(filePath, &error)) {
+        QMessageBox::critical(this, "Error", QString("Import failed: %1").arg(error));
+        return;
+    }
+    ProgressStats::instance().rebuild();
+    refreshTable();
+    QMessageBox::information(this, "Success", "ההתקדמות יובאה בהצלחה.");
+}
+
+void StatsTableWidget::exportDeviceState()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "שמור קובץ מכשיר", "device.elad", "Device state (*.elad)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    ProgressLog log;
+    QString error;
+    if (!ProgressSync(settings, log).exportState(filePath, &error)) {
+        QMessageBox::critical(this, "Error", QString("Export failed: %1").arg(error));
+        return;
+    }
+    QMessageBox::information(this, "Success", "קובץ המכשיר נשמר בהצלחה.");
+}
+
+void StatsTableWidget::mergeDeviceState()
+{
+    QStringList filePaths = QFileDialog::getOpenFileNames(this, "מזג קובץ מכשיר", QString(), "Device state (*.elad)");
+    if (filePaths.isEmpty()) {
+        return;
+    }
+
+    QSettings settings("MyCompany", "EnglishLearningApp");
+    ProgressLog log;
+    ProgressSync sync(settings, log);
+    for (const QString& filePath : filePaths) {
+        QString error;
+        if (!sync.mergeState(filePath, &error)) {
+            QMessageBox::critical(this, "Error", QString("Merge of %1 failed: %2").arg(filePath).arg(error));
+            return;
+        }
+    }
+    ProgressStats::instance().rebuild();
+    refreshTable();
+    QMessageBox::information(this, "Success", "ההתקדמות מוזגה בהצלחה.");
+}
+
 void StatsTableWidget::addScore(const QString& gameType, int score)
 {
     QSettings settings("MyCompany", "EnglishLearningApp");
@@ -159,11 +263,10 @@ void StatsTableWidget::deleteUserScores(QTableWidget* table)
         }
     }
 
-    for (int i = table->rowCount() - 1; i >= 0; --i) {
-        if (table->item(i, 0)->text() == userName) {
-            table->removeRow(i);
-        }
-    }
+    ProgressLog().remove(userName);
+    ProgressStats::instance().removeUser(userName);
+    ConfusionMatrix::instance().removeUser(userName);
+    refreshTable();
 
     QMessageBox::information(this, "Success", "Your scores have been deleted.");
 }
@@ -0,0 +1,126 @@
+#include "Trace.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+struct Event {
+    const char* name;
+    qint64 startNs;
+    qint64 durationNs;
+    int thread;
+};
+
+struct State {
+    std::atomic<bool> enabled { false };
+    QElapsedTimer clock;
+    QMutex mutex;
+    QList<Event> events;
+    QByteArray path;
+};
+
+State& state()
+{
+    static State state;
+    return state;
+}
+
+// Small sequential ids read better in the viewer than native thread handles.
+int threadIndex()
+{
+    static std::atomic<int> next { 0 };
+    thread_local int index = ++next;
+    return index;
+}
+
+QByteArray micros(qint64 ns)
+{
+    return QByteArray::number(ns / 1000.0, 'f', 3);
+}
+}
+
+void Trace::startFromArguments(int argc, char* argv[])
+{
+    State& s = state();
+    s.path = qgetenv("ELA_TRACE");
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            s.path = argv[i + 1];
+        }
+    }
+    if (s.path.isEmpty()) {
+        return;
+    }
+
+    threadIndex();
+    s.clock.start();
+    s.enabled = true;
+    // state() is constructed above, so it is still alive when this runs.
+    std::atexit(&Trace::write);
+}
+
+bool Trace::isEnabled()
+{
+    return state().enabled;
+}
+
+Trace::Span::Span(const char* name)
+    : name(name)
+    , startNs(Trace::isEnabled() ? state().clock.nsecsElapsed() : -1)
+{
+}
+
+Trace::Span::~Span()
+{
+    end();
+}
+
+void Trace::Span::end()
+{
+    if (startNs >= 0) {
+        Trace::record(name, startNs, state().clock.nsecsElapsed());
+        startNs = -1;
+    }
+}
+
+void Trace::record(const char* name, qint64 startNs, qint64 endNs)
+{
+    State& s = state();
+    int thread = threadIndex();
+    QMutexLocker locker(&s.mutex);
+    s.events.append({ name, startNs, endNs - startNs, thread });
+}
+
+void Trace::write()
+{
+    State& s = state();
+    QMutexLocker locker(&s.mutex);
+    s.enabled = false;
+
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"EnglishLearningApp\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}";
+    for (const Event& event : s.events) {
+        json += ",\n{\"name\":\"";
+        json += event.name;
+        json += "\",\"cat\":\"app\",\"ph\":\"X\",\"ts\":" + micros(event.startNs)
+            + ",\"dur\":" + micros(event.durationNs)
+            + ",\"pid\":1,\"tid\":" + QByteArray::number(event.thread) + "}";
+    }
+    json += "\n]}\n";
+
+    // Runs after QCoreApplication is gone, so report with stdio only.
+    QFile file(QString::fromLocal8Bit(s.path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        std::fprintf(stderr, "trace: cannot write %s\n", s.path.constData());
+        return;
+    }
+    std::fprintf(stderr, "trace: %lld spans written to %s\n", static_cast<long long>(s.events.size()), s.path.constData());
+}
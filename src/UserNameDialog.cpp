@@ -1,4 +1,7 @@
 #include "UserNameDialog.h"
+#include "AppStyle.h"
+#include "BackgroundCache.h"
+#include "Trace.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -12,6 +15,7 @@
 
 UserNameDialog::UserNameDialog(QWidget* parent)
     : QDialog(parent), userNameEdit(new QLineEdit(this)), passwordEdit(new QLineEdit(this)), imageLabel(new QLabel(this)) {
+    ELA_TRACE_SCOPE("UserNameDialog::UserNameDialog");
     setWindowTitle("Login");
 
     QIcon windowIcon(":/Learn-English-Icon.png");
@@ -20,8 +24,7 @@ UserNameDialog::UserNameDialog(QWidget* parent)
     imageLabel->setScaledContents(true); 
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     
-    QPixmap pixmap(":/Learn-English.png");
-    imageLabel->setPixmap(pixmap.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    BackgroundCache::applyTo(imageLabel, 1.0, QSize(600, 400));
     imageLabel->setFixedSize(600, 400); 
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
@@ -29,28 +32,28 @@ UserNameDialog::UserNameDialog(QWidget* parent)
     mainLayout->addWidget(imageLabel);
     
     QWidget* contentWidget = new QWidget(this);
-    contentWidget->setStyleSheet("background: transparent;"); 
+    AppStyle::setRole(contentWidget, "content");
     QVBoxLayout* contentLayout = new QVBoxLayout(contentWidget);
 
     QLabel* heading = new QLabel("Learn,practice,succeed!", this);
     QFont handwrittenFont("Comic Sans MS", 20);
     handwrittenFont.setBold(true);
     heading->setFont(handwrittenFont);
-    heading->setStyleSheet("color: rgb(23, 22, 22); text-align: center;");
+    AppStyle::setRole(heading, "heading");
     heading->setAlignment(Qt::AlignCenter);
     contentLayout->addWidget(heading);
 
     userNameEdit->setPlaceholderText("שם משתמש");
-    userNameEdit->setStyleSheet("background-color: rgba(255, 255, 255, 0.8); border: none; border-radius: 8px; padding: 10px; font-size: 16px;");
+    AppStyle::setRole(userNameEdit, "login");
     contentLayout->addWidget(userNameEdit);
 
     passwordEdit->setPlaceholderText("סיסמה");
     passwordEdit->setEchoMode(QLineEdit::Password);
-    passwordEdit->setStyleSheet("background-color: rgba(255, 255, 255, 0.8); border: none; border-radius: 8px; padding: 10px; font-size: 16px;");
+    AppStyle::setRole(passwordEdit, "login");
     contentLayout->addWidget(passwordEdit);
 
     QPushButton* loginButton = new QPushButton("התחבר", this);
-    loginButton->setStyleSheet("background-color: #ebbf00; color: white; border-radius: 8px; padding: 10px; font-size: 16px; font-weight: bold;");
+    AppStyle::setRole(loginButton, "login");
     connect(loginButton, &QPushButton::clicked, this, &UserNameDialog::validateUserName);
     contentLayout->addWidget(loginButton);
     
@@ -71,6 +74,7 @@ QString UserNameDialog::getPassword() const {
 }
 
 void UserNameDialog::validateUserName() {
+    ELA_TRACE_SCOPE("UserNameDialog::validateUserName");
     QSettings settings("MyCompany", "EnglishLearningApp");
     QString userName = userNameEdit->text();
     QString password = passwordEdit->text();
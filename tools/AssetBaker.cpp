@@ -0,0 +1,111 @@
+// Build-time tool: turns the full-size artwork into exactly the variants the
+// UI shows, so the application never decodes or scales the originals.
+//
+//   asset_baker --background Learn-English.png --icon Learn-English-Icon.png
+//               --out <dir> --window-color f0f0f0 --variants 600x400:30,...
+//               --icon-size 256
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+
+namespace {
+qint64 decodeMicroseconds(const QString& path)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QImage image(path);
+    return image.isNull() ? -1 : timer.nsecsElapsed() / 1000;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption backgroundOption("background", "Full-size background artwork.", "file");
+    QCommandLineOption iconOption("icon", "Full-size application icon.", "file");
+    QCommandLineOption outOption("out", "Output directory.", "dir");
+    QCommandLineOption colorOption("window-color", "Window colour (hex RGB) faded variants are flattened onto.", "rgb", "f0f0f0");
+    QCommandLineOption variantsOption("variants", "Comma separated WIDTHxHEIGHT:OPACITY_PERCENT list.", "list");
+    QCommandLineOption iconSizeOption("icon-size", "Edge length of the baked icon.", "pixels", "256");
+    parser.addOptions({ backgroundOption, iconOption, outOption, colorOption, variantsOption, iconSizeOption });
+    parser.process(app);
+
+    QDir outDir(parser.value(outOption));
+    outDir.mkpath(".");
+
+    QString backgroundPath = parser.value(backgroundOption);
+    QImage source(backgroundPath);
+    if (source.isNull()) {
+        qCritical("Could not read %s", qPrintable(backgroundPath));
+        return 1;
+    }
+
+    QColor base(QRgb(parser.value(colorOption).toUInt(nullptr, 16)));
+    qint64 bakedBytes = 0;
+    QString firstBaked;
+
+    const QStringList variants = parser.value(variantsOption).split(',', Qt::SkipEmptyParts);
+    for (const QString& variant : variants) {
+        QStringList sizeAndOpacity = variant.split(':');
+        QStringList size = sizeAndOpacity.value(0).split('x');
+        int width = size.value(0).toInt();
+        int height = size.value(1).toInt();
+        int opacity = sizeAndOpacity.value(1, "100").toInt();
+        if (width <= 0 || height <= 0) {
+            qCritical("Bad variant %s", qPrintable(variant));
+            return 1;
+        }
+
+        for (int dpr = 1; dpr <= 2; ++dpr) {
+            QImage scaled = source.scaled(QSize(width, height) * dpr, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+
+            // The artwork has no alpha channel, so a faded variant is fully
+            // described by flattening it onto the window colour.
+            QImage flat(scaled.size(), QImage::Format_RGB32);
+            flat.fill(base);
+            QPainter painter(&flat);
+            painter.setOpacity(opacity / 100.0);
+            painter.drawImage(0, 0, scaled);
+            painter.end();
+
+            QString name = QString("background_%1x%2_o%3@%4x.jpg").arg(width).arg(height).arg(opacity).arg(dpr);
+            QString path = outDir.filePath(name);
+            if (!flat.save(path, "JPG", 85)) {
+                qCritical("Could not write %s", qPrintable(path));
+                return 1;
+            }
+            bakedBytes += QFileInfo(path).size();
+            if (firstBaked.isEmpty()) {
+                firstBaked = path;
+            }
+        }
+    }
+
+    QString iconPath = parser.value(iconOption);
+    if (!iconPath.isEmpty()) {
+        int iconSize = parser.value(iconSizeOption).toInt();
+        QImage icon(iconPath);
+        QString path = outDir.filePath("Learn-English-Icon.png");
+        if (icon.isNull() || !icon.scaled(iconSize, iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation).save(path, "PNG")) {
+            qCritical("Could not bake icon %s", qPrintable(iconPath));
+            return 1;
+        }
+        bakedBytes += QFileInfo(path).size();
+    }
+
+    qint64 originalBytes = QFileInfo(backgroundPath).size() + (iconPath.isEmpty() ? 0 : QFileInfo(iconPath).size());
+    out << "asset_baker: " << originalBytes << " bytes of originals -> " << bakedBytes << " bytes baked\n";
+    out << "asset_baker: decode " << QFileInfo(backgroundPath).fileName() << " " << decodeMicroseconds(backgroundPath)
+        << " us, " << QFileInfo(firstBaked).fileName() << " " << decodeMicroseconds(firstBaked) << " us\n";
+    return 0;
+}